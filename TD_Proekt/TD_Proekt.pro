@@ -1,6 +1,6 @@
 QT       += core gui
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
 
 CONFIG += c++11
 
@@ -9,23 +9,66 @@ CONFIG += c++11
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    assets.cpp \
+    batchrunner.cpp \
     button.cpp \
+    config.cpp \
     enemy.cpp \
+    enemygrid.cpp \
+    enemytable.cpp \
+    framecapture.cpp \
     game.cpp \
     gameobject.cpp \
+    hitgrid.cpp \
     image.cpp \
+    loadmeter.cpp \
     main.cpp \
+    memorystats.cpp \
+    pathindex.cpp \
+    projectilepool.cpp \
+    savegame.cpp \
+    scenario.cpp \
+    simulation.cpp \
+    spriteatlas.cpp \
+    spritebatch.cpp \
+    spritesheet.cpp \
+    statuseffects.cpp \
+    tilegrid.cpp \
     tower.cpp \
+    towertable.cpp \
+    viewport.cpp \
     wavegenerator.cpp
 
 HEADERS += \
+    assets.h \
+    batchrunner.h \
     button.h \
+    config.h \
     enemy.h \
+    enemygrid.h \
+    enemytable.h \
+    framecapture.h \
     game.h \
     gameobject.h \
+    hitgrid.h \
     image.h \
+    loadmeter.h \
+    memorystats.h \
+    pathindex.h \
+    projectilepool.h \
+    savegame.h \
+    scenario.h \
+    simulation.h \
+    spriteatlas.h \
+    spritebatch.h \
+    spritesheet.h \
+    statehash.h \
+    statuseffects.h \
     tile.h \
+    tilegrid.h \
     tower.h \
+    towertable.h \
+    viewport.h \
     wavegenerator.h \
     waypoint.h
 
@@ -38,3 +81,16 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 RESOURCES += \
     images.qrc
 
+# qmake CONFIG+=pack_assets packs every image from images.qrc into a premultiplied, pre-scaled bundle next to
+# the binary once it is linked, the game maps it at startup instead of decoding the PNGs (see Assets::pack).
+# It runs the binary just built, so leave it off when cross-compiling and run --pack-assets <file> on the target.
+pack_assets {
+    win32: QMAKE_POST_LINK += $(DESTDIR_TARGET) --pack-assets $(DESTDIR)assets.bundle
+    else: QMAKE_POST_LINK += ./$(TARGET) --pack-assets assets.bundle
+
+    bundle.files = $$OUT_PWD/assets.bundle
+    bundle.path = $$target.path
+    bundle.CONFIG += no_check_exist
+    !isEmpty(target.path): INSTALLS += bundle
+}
+
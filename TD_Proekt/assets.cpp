@@ -0,0 +1,168 @@
+#include "assets.h"
+#include "memorystats.h"
+
+#include <QtConcurrent>
+#include <QDirIterator>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using namespace ASSETS;
+
+static_assert(sizeof(Header) == 6*4, "Header layout changed, bump ASSETS::VERSION");
+static_assert(sizeof(Entry) == 7*4, "Entry layout changed, bump ASSETS::VERSION");
+
+QFile* Assets::bundleFile = NULL;
+std::map<Assets::Key, QImage> Assets::bundled;
+std::map<QString, QFuture<QImage> > Assets::pending;
+std::map<QString, QImage> Assets::decoded;
+
+static inline quint32 align(quint32 offset){
+    return (offset + ALIGN - 1) / ALIGN * ALIGN;
+}
+
+//The file stays mapped for the life of the process, the bundled images point straight into it
+bool Assets::openBundle(const QString& filePath){
+    QFile* file = new QFile(filePath);
+    //Mapped read only, so the images over it must never be written to: they are built from a const pointer,
+    //which makes Qt copy the pixels before any write
+    const uchar* data = NULL;
+    if(file->open(QIODevice::ReadOnly) && file->size() >= (qint64)sizeof(Header))
+        data = file->map(0, file->size());
+    if(data == NULL){
+        delete file;
+        return false;
+    }
+
+    const Header* h = reinterpret_cast<const Header*>(data);
+    quint32 size = file->size();
+    if(std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->version != VERSION || h->fileSize != size ||
+       h->indexOffset % 4 != 0 || h->indexOffset > size || h->count > (size - h->indexOffset)/sizeof(Entry) ||
+       h->stringOffset > size){
+        delete file;
+        return false;
+    }
+
+    const Entry* e = reinterpret_cast<const Entry*>(data + h->indexOffset);
+    for(quint32 i = 0; i < h->count; i++, e++){
+        if(e->pathOffset > size - h->stringOffset || e->pathLength > size - h->stringOffset - e->pathOffset ||
+           e->dataOffset % 4 != 0 || e->bytesPerLine < e->width*4 || e->dataOffset > size ||
+           (quint64)e->bytesPerLine*e->height > size - e->dataOffset)
+            continue;
+        QString path = QString::fromUtf8(reinterpret_cast<const char*>(data + h->stringOffset + e->pathOffset), e->pathLength);
+        bundled[Key(path, e->scale)] = QImage(data + e->dataOffset, e->width, e->height, e->bytesPerLine,
+                                               QImage::Format_ARGB32_Premultiplied);
+    }
+
+    bundleFile = file;
+    MemoryStats::track(MemoryStats::BUNDLE, 1, file->size());
+    return true;
+}
+
+//Build step: every compiled-in PNG at each scale it is used at, converted once so the game never decodes or scales them
+bool Assets::pack(const QString& filePath){
+    std::vector<std::pair<QString, qreal> > items;
+    QDirIterator it(":/", QStringList{"*.png"}, QDir::Files, QDirIterator::Subdirectories);
+    while(it.hasNext()){
+        QString path = it.next();
+        if(path.startsWith(":/qt-project.org"))
+            continue;
+        items.push_back(std::make_pair(path, 1.0));
+        for(const auto& extra : EXTRA_SCALES)
+            if(path.startsWith(extra.prefix))
+                items.push_back(std::make_pair(path, extra.scale));
+    }
+    std::sort(items.begin(), items.end());
+
+    std::vector<Entry> index;
+    std::vector<QImage> images;
+    QByteArray strings;
+    for(const auto& item : items){
+        QImage image = scaled(QImage(item.first), item.second).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        if(image.isNull())
+            continue;
+        QByteArray path = item.first.toUtf8();
+        Entry e;
+        e.pathOffset = strings.size();
+        e.pathLength = path.size();
+        e.scale = scaleKey(item.second);
+        e.width = image.width();
+        e.height = image.height();
+        e.bytesPerLine = image.bytesPerLine();
+        strings.append(path);
+        index.push_back(e);
+        images.push_back(image);
+    }
+
+    Header h;
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.count = index.size();
+    h.indexOffset = sizeof(Header);
+    h.stringOffset = h.indexOffset + h.count*sizeof(Entry);
+    quint32 offset = h.stringOffset + strings.size();
+    for(auto& e : index){
+        e.dataOffset = align(offset);
+        offset = e.dataOffset + e.bytesPerLine*e.height;
+    }
+    h.fileSize = offset;
+
+    QByteArray buffer(h.fileSize, 0);
+    char* out = buffer.data();
+    std::memcpy(out, &h, sizeof(Header));
+    if(!index.empty())
+        std::memcpy(out + h.indexOffset, index.data(), index.size()*sizeof(Entry));
+    std::memcpy(out + h.stringOffset, strings.constData(), strings.size());
+    for(size_t i = 0; i < index.size(); i++)
+        std::memcpy(out + index[i].dataOffset, images[i].constBits(), index[i].bytesPerLine*index[i].height);
+
+    QSaveFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+    if(file.write(buffer) != buffer.size()){
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+void Assets::prefetch(const QStringList& paths){
+    for(const auto& path : paths){
+        if(path.isEmpty() || bundled.count(Key(path, scaleKey(1))) != 0 || decoded.count(path) != 0 || pending.count(path) != 0)
+            continue;
+        pending[path] = QtConcurrent::run([path]{ return QImage(path); });
+    }
+}
+
+QImage Assets::image(const QString& path, qreal scale){
+    auto packed = bundled.find(Key(path, scaleKey(scale)));
+    if(packed != bundled.end())
+        return packed->second;
+    return scaled(raw(path), scale);
+}
+
+QImage Assets::raw(const QString& path){
+    auto packed = bundled.find(Key(path, scaleKey(1)));
+    if(packed != bundled.end())
+        return packed->second;
+
+    auto done = decoded.find(path);
+    if(done != decoded.end())
+        return done->second;
+
+    auto queued = pending.find(path);
+    QImage i = queued != pending.end() ? queued->second.result() : QImage(path);
+    if(queued != pending.end())
+        pending.erase(queued);
+    decoded[path] = i;
+    MemoryStats::track(MemoryStats::DECODED, 1, MemoryStats::bytes(i));
+    return i;
+}
+
+//The scaling GameObject has always applied, kept in one place so packed and decoded images match
+QImage Assets::scaled(const QImage& raw, qreal scale){
+    if(scale == 1 || raw.isNull())
+        return raw;
+    return raw.scaled(raw.width()/scale, raw.height()/scale, Qt::KeepAspectRatio);
+}
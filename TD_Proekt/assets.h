@@ -0,0 +1,88 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include <QFile>
+#include <QFuture>
+#include <QImage>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <map>
+#include <utility>
+
+
+namespace ASSETS{
+    const char MAGIC[4] = {'T','D','A','B'};
+    const quint32 VERSION = 1;
+    const QString BUNDLE_FILE = "assets.bundle";
+    const quint32 ALIGN = 16;
+
+    //Scales other than 1 the game asks GameObject for, and the images each is used with. The bundle holds
+    //a copy of every matching image at that scale, so anything drawn at a new scale belongs in here.
+    const qreal TITLE_SCALE = 0.125;
+    const qreal BUTTON_SCALE = 0.25;
+    const qreal BACK_SCALE = 0.5;
+
+    struct ExtraScale{
+        const char* prefix;
+        qreal scale;
+    };
+
+    const ExtraScale EXTRA_SCALES[] = {
+        {":/characters/", TITLE_SCALE},
+        {":/characters/", BUTTON_SCALE},
+        {":/characters/", BACK_SCALE},
+        {":/leftarrow", BUTTON_SCALE},
+        {":/rightarrow", BUTTON_SCALE}
+    };
+
+    //Bundle layout: Header, Entry index, UTF-8 path strings, then the pixel rows of every image,
+    //premultiplied ARGB32 and each starting on an ALIGN boundary so it can be wrapped in place
+    struct Header{
+        char magic[4];
+        quint32 version;
+        quint32 fileSize;
+        quint32 count;
+        quint32 indexOffset;
+        quint32 stringOffset;
+    };
+
+    struct Entry{
+        quint32 pathOffset;  //relative to stringOffset
+        quint32 pathLength;
+        quint32 scale;       //GameObject scale in thousandths
+        quint32 width;
+        quint32 height;
+        quint32 bytesPerLine;
+        quint32 dataOffset;
+    };
+}
+
+//Images by resource path and scale. A bundle written at build time is mapped and its images are used in place,
+//anything not in it is decoded on the global thread pool when prefetched, or on the spot otherwise.
+//Only called from the GUI thread, except for BatchRunner's workers, which find every image they ask for
+//already decoded.
+class Assets
+{
+public:
+    static bool openBundle(const QString& filePath);
+    static bool pack(const QString& filePath);
+
+    static void prefetch(const QStringList& paths);
+    static QImage image(const QString& path, qreal scale = 1);
+
+    inline static int getBundleSize() { return bundled.size(); }
+private:
+    typedef std::pair<QString, int> Key;  //path, scale in thousandths
+
+    static QFile* bundleFile;
+    static std::map<Key, QImage> bundled;
+    static std::map<QString, QFuture<QImage> > pending;
+    static std::map<QString, QImage> decoded;
+
+    static QImage raw(const QString& path);
+    static QImage scaled(const QImage& raw, qreal scale);
+    inline static int scaleKey(qreal scale) { return qRound(scale*1000); }
+};
+
+#endif // ASSETS_H
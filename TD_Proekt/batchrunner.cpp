@@ -0,0 +1,123 @@
+#include "batchrunner.h"
+#include "simulation.h"
+#include "assets.h"
+
+#include <QElapsedTimer>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+bool BatchRunner::parse(const QStringList& args, BatchRunner& out){
+    int at = args.indexOf(BATCH::ARGUMENT);
+    if(at < 0)
+        return false;
+
+    int* counts[] = {&out.games, &out.waves, &out.towers};
+    for(int i = 0; i < 3; i++){
+        bool ok = false;
+        int n = at+1+i < args.size() ? args[at+1+i].toInt(&ok) : 0;
+        if(ok && n >= 0)
+            *counts[i] = n;
+    }
+    if(at+4 < args.size())
+        out.output = args[at+4];
+    return true;
+}
+
+//Expects Simulation::loadTables to have run
+bool BatchRunner::run(){
+    //Tower sprites are decoded here, so the workers only ever find them in the cache
+    for(int t = 0; t < Tower::getTypeCount(); t++)
+        Assets::image(TowerTable::get(t).sprite);
+
+    results.assign(games, GameResult());
+    for(int i = 0; i < games; i++)
+        results[i].seed = BATCH::FIRST_SEED + i;
+
+    QElapsedTimer clock;
+    clock.start();
+    threads = QThreadPool::globalInstance()->maxThreadCount();
+    QtConcurrent::blockingMap(results, [this](GameResult& r){ play(r); });
+    elapsedMs = clock.elapsed();
+    return write();
+}
+
+//One game from the first wave until it is lost or the last wave is cleared, towers placed once up front
+void BatchRunner::play(GameResult& r) const{
+    Simulation sim;
+    sim.seed(r.seed);
+    std::default_random_engine layout(r.seed);
+
+    TileGrid& tiles = sim.getTiles();
+    std::vector<int> free;
+    for(int t = tiles.nextBuildable(0); t >= 0; t = tiles.nextBuildable(t+1))
+        free.push_back(t);
+    std::shuffle(free.begin(), free.end(), layout);
+    std::uniform_int_distribution<int> type(0, Tower::getTypeCount()-1);
+    std::uniform_int_distribution<int> targeting(static_cast<int>(Targeting::FIRST), static_cast<int>(Targeting::CLOSEST));
+    for(int i = 0; i < towers && i < int(free.size()); i++){
+        Tower* t = new Tower(static_cast<Type>(type(layout)), tiles.rectOf(free[i]));
+        t->setTargeting(static_cast<Targeting>(targeting(layout)));
+        sim.addTower(t);
+    }
+
+    for(int w = 0; w < waves; w++){
+        sim.newWave();
+        qint64 end = sim.getTick() + BATCH::MAX_WAVE_TICKS;
+        while(sim.getOutcome() == Simulation::PLAYING && sim.getTick() < end)
+            sim.tick();
+        if(sim.getOutcome() != Simulation::WAVE_CLEARED)
+            break;
+        r.scores.push_back(sim.getScore());
+    }
+    r.ticks = sim.getTick();
+}
+
+//One row per wave: how many games reached it, how many cleared it, and the score of those that did
+bool BatchRunner::write() const{
+    std::string csv = "wave,games,survived,survival,score_mean,score_min,score_max\n";
+    for(int w = 0; w < waves; w++){
+        int reached = 0, survived = 0;
+        int lo = 0, hi = 0;
+        double total = 0;
+        for(const auto& r : results){
+            if(int(r.scores.size()) < w)
+                continue;
+            reached++;
+            if(int(r.scores.size()) == w)
+                continue;
+            int s = r.scores[w];
+            lo = survived == 0 ? s : std::min(lo, s);
+            hi = survived == 0 ? s : std::max(hi, s);
+            total += s;
+            survived++;
+        }
+        char line[128];
+        std::snprintf(line, sizeof(line), "%d,%d,%d,%.4f,%.1f,%d,%d\n", w+1, reached, survived,
+                      reached > 0 ? survived/double(reached) : 0.0, survived > 0 ? total/survived : 0.0, lo, hi);
+        csv += line;
+    }
+
+    QSaveFile file(output);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+    if(file.write(csv.data(), csv.size()) != qint64(csv.size())){
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+std::string BatchRunner::report() const{
+    qint64 ticks = 0;
+    for(const auto& r : results)
+        ticks += r.ticks;
+    char line[200];
+    std::snprintf(line, sizeof(line), "batch %d games, %d waves, %d towers: %lld ms on %d threads, %.0f ticks/s -> %s",
+                  games, waves, towers, (long long)elapsedMs, threads, elapsedMs > 0 ? ticks*1000.0/elapsedMs : 0.0,
+                  output.toLocal8Bit().constData());
+    return line;
+}
@@ -0,0 +1,60 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <string>
+#include <vector>
+
+
+namespace BATCH{
+    const QString ARGUMENT = "--batch";
+    const int DEFAULT_GAMES = 1000;
+    const int DEFAULT_WAVES = 30;
+    const int DEFAULT_TOWERS = 12;
+    const QString DEFAULT_OUTPUT = "batch.csv";
+    const unsigned int FIRST_SEED = 1;    //game i is seeded with FIRST_SEED + i, so a sweep can be repeated
+    const qint64 MAX_WAVE_TICKS = 200000; //a wave still running after this long counts as lost
+}
+
+//How far one headless game got
+class GameResult
+{
+public:
+    GameResult() : seed(0), ticks(0) {}
+
+    unsigned int seed;
+    std::vector<int> scores;  //score after each cleared wave
+    qint64 ticks;
+};
+
+//Plays many independent games without a window and writes per-wave survival and score statistics as CSV.
+//Every game is one task on the global thread pool with its own Simulation, seed and random tower layout.
+//Games share nothing but the archetype tables, which are loaded before the first task starts and only
+//read afterwards, so throughput grows with the number of cores.
+class BatchRunner
+{
+public:
+    BatchRunner(int games = BATCH::DEFAULT_GAMES, int waves = BATCH::DEFAULT_WAVES, int towers = BATCH::DEFAULT_TOWERS) :
+        games(games), waves(waves), towers(towers), output(BATCH::DEFAULT_OUTPUT), threads(0), elapsedMs(0) {}
+
+    //--batch [games] [waves] [towers] [file], false when the argument is not there
+    static bool parse(const QStringList& args, BatchRunner& out);
+
+    bool run();
+    std::string report() const;
+private:
+    int games;
+    int waves;
+    int towers;
+    QString output;
+    int threads;
+    qint64 elapsedMs;
+    std::vector<GameResult> results;
+
+    void play(GameResult& r) const;
+    bool write() const;
+};
+
+#endif // BATCHRUNNER_H
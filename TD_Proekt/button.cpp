@@ -1,16 +1,21 @@
 #include "button.h"
+#include "assets.h"
+#include "memorystats.h"
 #include <QImage>
 
 
-Button::Button(QString filePath, QString h_filePath, qreal scale): Image(filePath, scale), active(false)
+Button::Button(QString filePath, QString h_filePath, qreal scale): Image(filePath, scale), activeImage(Assets::image(h_filePath, scale)), active(false)
 {
-    QImage* raw = new QImage(h_filePath);
-    activeImage = new QImage(raw->scaled(raw->width()/scale, raw->height()/scale, Qt::KeepAspectRatio));
+    MemoryStats::track(MemoryStats::GAME_OBJECTS, 0, MemoryStats::bytes(activeImage));
 }
 
 
-Button::Button(Image* passive, Image* active) : Image(*passive), activeImage(active->getImage()), active(false){}
+Button::Button(Image* passive, Image* hover) : Image(*passive), activeImage(*hover->getImage()), active(false){
+    MemoryStats::track(MemoryStats::GAME_OBJECTS, 0, MemoryStats::bytes(activeImage));
+    delete passive;
+    delete hover;
+}
 
 Button::~Button(){
-    delete activeImage;
+    MemoryStats::track(MemoryStats::GAME_OBJECTS, 0, -MemoryStats::bytes(activeImage));
 }
@@ -9,15 +9,15 @@ class Button : public Image
 public:
     //Constructor
     Button(QString filePath, QString h_filePath, qreal scale);
-    Button(Image* passive, Image* active);
+    Button(Image* passive, Image* hover); //Takes ownership of both images
     ~Button();
 
     inline void setActive(bool a){ active = a; }
     inline bool isActive() const { return active; }
-    inline QImage getActiveImage() const { return *activeImage; }
+    inline const QImage& getActiveImage() const { return activeImage; }
 private:
 
-    QImage* activeImage;
+    QImage activeImage;
     bool active;
 };
 
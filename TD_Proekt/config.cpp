@@ -0,0 +1,74 @@
+#include "config.h"
+
+#include <QFile>
+#include <QCoreApplication>
+#include <QDir>
+
+
+bool ConfigSection::contains(QString key) const{
+    for(const auto& v : values)
+        if(v.first == key)
+            return true;
+    return false;
+}
+
+QString ConfigSection::getString(QString key, QString def) const{
+    //Last assignment wins, like most ini readers
+    for(auto it = values.rbegin(); it != values.rend(); ++it)
+        if(it->first == key)
+            return it->second;
+    return def;
+}
+
+int ConfigSection::getInt(QString key, int def) const{
+    bool ok = false;
+    int v = getString(key).toInt(&ok);
+    return ok ? v : def;
+}
+
+double ConfigSection::getDouble(QString key, double def) const{
+    bool ok = false;
+    double v = getString(key).toDouble(&ok);
+    return ok ? v : def;
+}
+
+bool ConfigSection::getBool(QString key, bool def) const{
+    QString v = getString(key).toLower();
+    if(v == "1" || v == "true" || v == "yes")
+        return true;
+    if(v == "0" || v == "false" || v == "no")
+        return false;
+    return def;
+}
+
+bool Config::load(QString filePath){
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    sections.clear();
+    while(!file.atEnd()){
+        QString line = QString::fromUtf8(file.readLine()).trimmed();
+        if(line.isEmpty() || line.startsWith("#") || line.startsWith(";"))
+            continue;
+
+        if(line.startsWith("[") && line.endsWith("]")){
+            sections.push_back(ConfigSection(line.mid(1, line.length()-2).trimmed()));
+            continue;
+        }
+
+        int eq = line.indexOf('=');
+        if(eq <= 0 || sections.empty())
+            continue;
+        sections.back().set(line.left(eq).trimmed(), line.mid(eq+1).trimmed());
+    }
+    return true;
+}
+
+//A file next to the executable overrides the copy compiled into the resources
+QString Config::locate(QString fileName){
+    QString external = QDir(QCoreApplication::applicationDirPath()).filePath(fileName);
+    if(QFile::exists(external))
+        return external;
+    return ":/" + fileName;
+}
@@ -0,0 +1,41 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <QString>
+#include <vector>
+#include <utility>
+
+
+//One [section] of a config file, keys keep the order they were written in
+class ConfigSection
+{
+public:
+    ConfigSection(QString n) : name(n) {}
+
+    inline QString getName() const { return name; }
+    inline void set(QString key, QString value) { values.push_back(std::make_pair(key, value)); }
+
+    bool contains(QString key) const;
+    QString getString(QString key, QString def = QString()) const;
+    int getInt(QString key, int def = 0) const;
+    double getDouble(QString key, double def = 0) const;
+    bool getBool(QString key, bool def = false) const;
+private:
+    QString name;
+    std::vector<std::pair<QString, QString>> values;
+};
+
+//Minimal "key = value" reader with [sections] and # comments
+class Config
+{
+public:
+    bool load(QString filePath);
+
+    inline const std::vector<ConfigSection>& getSections() const { return sections; }
+
+    static QString locate(QString fileName);
+private:
+    std::vector<ConfigSection> sections;
+};
+
+#endif // CONFIG_H
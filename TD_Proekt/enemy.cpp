@@ -1,72 +1,65 @@
 #include "enemy.h"
+#include "memorystats.h"
+#include <cmath>
+#include <algorithm>
 
 
-Enemy::Enemy(Enemy_Type type, QPointF p) : GameObject(), currentWaypoint(0),
-     dead(false), spawnDelay(2000), faceRight(false)
+Enemy::Enemy(int archetype, QPointF p) : archetype(archetype), currentWaypoint(0),
+     health(EnemyTable::get(archetype).health), dead(false), faceRight(false),
+     frame(0), frameTimer(0), speedFactor(1), stride(0)
 {
-    if(type == Enemy_Type::NORMAL){
-        leftAnimation = new Image(ENEMY::NORMAL_L);
-        rightAnimation = new Image(ENEMY::NORMAL_R);
-        health = 3;
-        score = 10;
-    }
-    else if(type == Enemy_Type::BADASS){
-        leftAnimation = new Image(ENEMY::BADASS_L);
-        rightAnimation = new Image(ENEMY::BADASS_R);
-        health = 10;
-        score = 15;
-    }
-    else if(type == Enemy_Type::BAT){
-        leftAnimation = new Image(ENEMY::BAT_L);
-        rightAnimation = new Image(ENEMY::BAT_R);
-        health = 15;
-        score = 20;
-    }
-
-    setImage(*leftAnimation->getImage());
-    setRect(*leftAnimation->getRect());
-
-    getRect()->translate(p.toPoint().rx()-getRect()->width()/2, p.toPoint().ry()-getRect()->height()/2);
+    rect = QRect(QPoint(0, 0), getSheet().getFrameSize());
+    rect.translate(p.toPoint().rx()-rect.width()/2, p.toPoint().ry()-rect.height()/2);
+    from = rect.center();
+    MemoryStats::track(MemoryStats::ENEMIES, 1, sizeof(Enemy));
 }
 
 Enemy::~Enemy(){
-    delete leftAnimation;
-    delete rightAnimation;
+    MemoryStats::track(MemoryStats::ENEMIES, -1, -qint64(sizeof(Enemy)));
 }
 
-void Enemy::move(QPointF w){
-    int x=0, y=0;
-
-    if(std::abs(w.rx() - getRect()->center().rx()) > 0.1 &&
-       std::abs(w.ry() - getRect()->center().ry()) > 0.1){
-        (w.rx() > getRect()->center().rx()) ? moveRight(x) : moveLeft(x);
-        (w.ry() > getRect()->center().ry()) ? y=1 : y=-1;
-    }
-    else if(std::abs(w.rx() - getRect()->center().rx()) > 0.1)
-        (w.rx() > getRect()->center().rx()) ? moveRight(x) : moveLeft(x);
-    else if(std::abs(w.ry() - getRect()->center().ry()) > 0.1)
-        (w.ry() > getRect()->center().ry()) ? y=1 : y=-1;
-
-    getRect()->translate(x, y);
+//Whole pixels to walk this tick, speed being scaled to the tick length. A slowed speed is accumulated,
+//so an enemy at half speed moves a pixel every other tick.
+int Enemy::startMove(float scale){
+    from = rect.center();
+    stride += getInfo().speed * speedFactor * scale;
+    speedFactor = 1;
+    int speed = int(stride);
+    stride -= speed;
+    return speed;
 }
 
-void Enemy::moveLeft(int& x){
-    x=-1;
-    faceRight = false;
-    setImage(*leftAnimation->getImage());
-}
+//One pixel on each axis towards w, or none on an axis already level with it
+void Enemy::step(QPointF w){
+    int dx = std::lround(w.x()) - rect.center().x();
+    int dy = std::lround(w.y()) - rect.center().y();
+    int x = std::max(-1, std::min(1, dx));
+    int y = std::max(-1, std::min(1, dy));
 
+    if(x != 0)
+        faceRight = x > 0;
 
-void Enemy::moveRight(int& x){
-    x=1;
-    faceRight = true;
-    setImage(*rightAnimation->getImage());
+    rect.translate(x, y);
 }
 
-
-Image Enemy::getAnimation() const{
-    if(faceRight)
-        return *rightAnimation;
-    else
-        return *leftAnimation;
+//Part of the last move during which the center was within range of c, as fractions of the move.
+//Treats the move as a segment, so an enemy that crossed the circle between two ticks is still found.
+bool Enemy::rangeWindow(QPoint c, int range, float& in, float& out) const{
+    QPointF f = QPointF(from - c);
+    QPointF d = QPointF(rect.center() - from);
+    double a = d.x()*d.x() + d.y()*d.y();
+    double k = f.x()*f.x() + f.y()*f.y() - double(range)*range;
+    if(a <= 0){
+        in = 0;
+        out = 1;
+        return k < 0;
+    }
+    double b = 2*(f.x()*d.x() + f.y()*d.y());
+    double disc = b*b - 4*a*k;
+    if(disc <= 0)
+        return false;
+    double root = std::sqrt(disc);
+    in = std::max(0.0, (-b - root)/(2*a));
+    out = std::min(1.0, (-b + root)/(2*a));
+    return in < out;
 }
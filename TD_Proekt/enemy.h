@@ -1,50 +1,68 @@
 #ifndef ENEMY_H
 #define ENEMY_H
 
-#include "gameobject.h"
-#include "image.h"
+#include "enemytable.h"
+#include <QRect>
+#include <QPoint>
+#include <QPointF>
 
 
-enum class Enemy_Type{NORMAL, BADASS, BAT};
-
-namespace ENEMY {
-    const QString NORMAL_L = ":/white ghost left.png";
-    const QString NORMAL_R = ":/white ghost right.png";
-    const QString BADASS_L = ":/red ghost left.png";
-    const QString BADASS_R = ":/red ghost right.png";
-    const QString BAT_L = ":/bat_l.png";
-    const QString BAT_R = ":/bat_r.png";
-}
-
-class Enemy : public GameObject
+//Only the mutable state lives here, everything shared by a type is in its EnemyArchetype
+class Enemy
 {
 public:
-    Enemy(Enemy_Type type, QPointF p);
+    Enemy(int archetype, QPointF p);
     ~Enemy();
 
-    void move(QPointF w);
+    int startMove(float scale);
+    void step(QPointF w);
+    bool rangeWindow(QPoint c, int range, float& in, float& out) const;
+    inline QRect* getRect(){ return &rect; }
+    inline QRect getRectV() const { return rect; }
+    inline QPoint getFrom() const { return from; }
+    //Center at fraction t of the last move, 1 is where the enemy is now
+    inline QPointF getCenterAt(float t) const { return QPointF(from) + t*QPointF(rect.center() - from); }
+    inline int getArchetype() const { return archetype; }
+    inline const EnemyArchetype& getInfo() const { return EnemyTable::get(archetype); }
+    inline const SpriteSheet& getSheet() const { return getInfo().sheet; }
+    inline const QRect& getFrame() const { return getSheet().getFrame(frame); }
+    inline bool isMirrored() const { return getSheet().isMirrored(faceRight); }
     inline int getCurWaypoint() const { return currentWaypoint; }
     inline void incrementCurWaypoint() { currentWaypoint++; }
     inline void inflictDamage(int d) { health -= d; }
     inline bool isDead() const { return dead; }
     inline int getHealth() const { return health; }
     inline void setDead(bool b) { dead = b; }
-    inline int getScore() const { return score; }
-    inline int getSpawnDelay() const { return spawnDelay; }
-    Image getAnimation() const;
+    inline int getScore() const { return getInfo().score; }
+    inline bool isFacingRight() const { return faceRight; }
+    inline void setCurWaypoint(int w) { currentWaypoint = w; }
+    inline void setHealth(int h) { health = h; }
+    inline void setFacingRight(bool b) { faceRight = b; }
+    inline void slowTo(float f) { if(f < speedFactor) speedFactor = f; }  //for the next move only
+    inline float getSpeedFactor() const { return speedFactor; }
+    inline float getStride() const { return stride; }
+    inline void setStride(float s) { stride = s; }
+
+    //Advances the animation by ms of simulated time
+    inline void animate(int ms){
+        frameTimer += ms;
+        if(frameTimer < getSheet().getFrameMs())
+            return;
+        frameTimer -= getSheet().getFrameMs();
+        frame = (frame + 1) % getSheet().getFrameCount();
+    }
 private:
+    QRect rect;
+    QPoint from;   //center before the last move
+    int archetype;
     int currentWaypoint;
     int health;
     bool dead;
-    int score;
-    int spawnDelay;
     bool faceRight;
-
-    Image* rightAnimation;
-    Image* leftAnimation;
-
-    void moveLeft(int& x);
-    void moveRight(int& x);
+    int frame;
+    int frameTimer;
+    float speedFactor;
+    float stride;  //movement owed from fractional speeds
 };
 
 #endif // ENEMY_H
@@ -0,0 +1,69 @@
+#include "enemygrid.h"
+#include <algorithm>
+
+
+EnemyGrid::EnemyGrid(QRect b, int size) : bounds(b), cellSize(size),
+    cols((b.width()+size-1)/size), rows((b.height()+size-1)/size), cellStart(cols*rows+1, 0) {}
+
+int EnemyGrid::column(int x) const{
+    return std::max(0, std::min(cols-1, (x - bounds.left())/cellSize));
+}
+
+int EnemyGrid::row(int y) const{
+    return std::max(0, std::min(rows-1, (y - bounds.top())/cellSize));
+}
+
+void EnemyGrid::rebuild(const std::vector<Enemy*>& enemies){
+    std::fill(cellStart.begin(), cellStart.end(), 0);
+    itemCell.resize(enemies.size());
+    items.resize(enemies.size());
+
+    for(size_t i = 0; i < enemies.size(); i++){
+        QPoint c = enemies[i]->getRect()->center();
+        itemCell[i] = row(c.y())*cols + column(c.x());
+        cellStart[itemCell[i]+1]++;
+    }
+    for(size_t c = 1; c < cellStart.size(); c++)
+        cellStart[c] += cellStart[c-1];
+
+    cursor.assign(cellStart.begin(), cellStart.end()-1);
+    for(size_t i = 0; i < enemies.size(); i++)
+        items[cursor[itemCell[i]]++] = enemies[i];
+}
+
+void EnemyGrid::queryRadius(QPoint center, int radius, std::vector<Enemy*>& out) const{
+    const int r2 = radius*radius;
+    for(int y = row(center.y()-radius); y <= row(center.y()+radius); y++){
+        for(int x = column(center.x()-radius); x <= column(center.x()+radius); x++){
+            int cell = y*cols + x;
+            for(int i = cellStart[cell]; i < cellStart[cell+1]; i++){
+                Enemy* e = items[i];
+                QPoint d = e->getRect()->center() - center;
+                if(!e->isDead() && d.x()*d.x() + d.y()*d.y() <= r2)
+                    out.push_back(e);
+            }
+        }
+    }
+}
+
+//Enemies within radius whose direction from the apex is at most acos(cosHalfAngle) away from direction
+void EnemyGrid::queryCone(QPoint apex, QPoint direction, int radius, double cosHalfAngle, std::vector<Enemy*>& out) const{
+    const int r2 = radius*radius;
+    const double dirLen2 = double(direction.x())*direction.x() + double(direction.y())*direction.y();
+    const double cos2 = cosHalfAngle*cosHalfAngle;
+    for(int y = row(apex.y()-radius); y <= row(apex.y()+radius); y++){
+        for(int x = column(apex.x()-radius); x <= column(apex.x()+radius); x++){
+            int cell = y*cols + x;
+            for(int i = cellStart[cell]; i < cellStart[cell+1]; i++){
+                Enemy* e = items[i];
+                QPoint v = e->getRect()->center() - apex;
+                int len2 = v.x()*v.x() + v.y()*v.y();
+                if(e->isDead() || len2 > r2)
+                    continue;
+                double dot = double(v.x())*direction.x() + double(v.y())*direction.y();
+                if(len2 == 0 || (dot > 0 && dot*dot >= cos2*len2*dirLen2))
+                    out.push_back(e);
+            }
+        }
+    }
+}
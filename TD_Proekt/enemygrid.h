@@ -0,0 +1,35 @@
+#ifndef ENEMYGRID_H
+#define ENEMYGRID_H
+
+#include "enemy.h"
+#include <QRect>
+#include <QPoint>
+#include <vector>
+
+
+//Uniform grid over enemy centers, rebuilt once per tick with a counting sort.
+//Each cell's enemies sit next to each other in one array, so area queries only touch the cells they overlap.
+class EnemyGrid
+{
+public:
+    EnemyGrid(QRect bounds, int cellSize);
+
+    void rebuild(const std::vector<Enemy*>& enemies);
+    void queryRadius(QPoint center, int radius, std::vector<Enemy*>& out) const;
+    void queryCone(QPoint apex, QPoint direction, int radius, double cosHalfAngle, std::vector<Enemy*>& out) const;
+private:
+    QRect bounds;
+    int cellSize;
+    int cols;
+    int rows;
+
+    std::vector<int> cellStart;  //cols*rows+1 offsets into items
+    std::vector<Enemy*> items;
+    std::vector<int> itemCell;
+    std::vector<int> cursor;
+
+    int column(int x) const;
+    int row(int y) const;
+};
+
+#endif // ENEMYGRID_H
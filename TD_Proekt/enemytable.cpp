@@ -0,0 +1,65 @@
+#include "enemytable.h"
+#include "config.h"
+#include "assets.h"
+
+#include <algorithm>
+
+std::vector<EnemyArchetype> EnemyTable::archetypes;
+
+double WaveCurve::getWeight(int wave) const{
+    if(wave < firstWave)
+        return 0;
+    double w = baseWeight + weightPerWave*(wave - firstWave);
+    if(maxWeight > 0 && w > maxWeight)
+        w = maxWeight;
+    return std::max(0.0, w);
+}
+
+int WaveCurve::getSpacing(int wave) const{
+    return std::max(minSpacing, baseSpacing - spacingPerWave*(wave - 1));
+}
+
+bool EnemyTable::load(QString filePath){
+    Config config;
+    if(!config.load(filePath))
+        return false;
+
+    //Start every sprite decoding at once, the loop below picks them up as they finish
+    QStringList sprites;
+    for(const auto& s : config.getSections()){
+        sprites.append(s.getString("sprite"));
+    }
+    Assets::prefetch(sprites);
+
+    std::vector<EnemyArchetype> table;
+    for(const auto& s : config.getSections()){
+        if(!s.contains("sprite"))
+            continue;
+
+        EnemyArchetype a;
+        a.name = s.getName();
+        a.health = s.getInt("health", 1);
+        a.speed = std::max(1, s.getInt("speed", 1));
+        a.score = s.getInt("score");
+        a.flying = s.getBool("flying");
+        a.armored = s.getBool("armored");
+        a.sprite = s.getString("sprite");
+        if(!a.sheet.load(a.sprite, s.getInt("frames", 1), s.getInt("frame_ms", ANIMATION::DEFAULT_FRAME_MS), s.getBool("faces_right")))
+            continue;
+
+        a.wave.tokenCost = std::max(1, s.getInt("tokens", 1));
+        a.wave.firstWave = s.getInt("first_wave", 1);
+        a.wave.baseWeight = s.getDouble("weight", 1);
+        a.wave.weightPerWave = s.getDouble("weight_per_wave");
+        a.wave.maxWeight = s.getDouble("weight_max");
+        a.wave.baseSpacing = s.getInt("spacing", 2000);
+        a.wave.spacingPerWave = s.getInt("spacing_per_wave");
+        a.wave.minSpacing = s.getInt("spacing_min", std::min(a.wave.baseSpacing, 2000));
+        table.push_back(a);
+    }
+    if(table.empty())
+        return false;
+
+    archetypes = table;
+    return true;
+}
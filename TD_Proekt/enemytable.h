@@ -0,0 +1,62 @@
+#ifndef ENEMYTABLE_H
+#define ENEMYTABLE_H
+
+#include "spritesheet.h"
+#include <QString>
+#include <vector>
+
+
+namespace ENEMY{
+    const QString CONFIG_FILE = "enemies.cfg";
+}
+
+//Weight, cost and spawn spacing of one enemy type as a function of the wave number
+class WaveCurve
+{
+public:
+    WaveCurve() : tokenCost(1), firstWave(1), baseWeight(1), weightPerWave(0), maxWeight(0),
+        baseSpacing(2000), spacingPerWave(0), minSpacing(2000) {}
+
+    double getWeight(int wave) const;
+    int getSpacing(int wave) const;
+
+    int tokenCost;
+    int firstWave;
+    double baseWeight;
+    double weightPerWave;
+    double maxWeight;  //0 = uncapped
+    int baseSpacing;
+    int spacingPerWave;
+    int minSpacing;
+};
+
+class EnemyArchetype
+{
+public:
+    EnemyArchetype() : health(1), speed(1), score(0), flying(false), armored(false) {}
+
+    QString name;
+    int health;
+    int speed;  //pixels per move tick
+    int score;
+    bool flying;   //read from the table, no rule checks them yet
+    bool armored;
+
+    QString sprite;
+    SpriteSheet sheet;  //every enemy of this type plays from it
+
+    WaveCurve wave;
+};
+
+class EnemyTable
+{
+public:
+    static bool load(QString filePath);
+
+    inline static int size() { return archetypes.size(); }
+    inline static const EnemyArchetype& get(int a) { return archetypes[a]; }
+private:
+    static std::vector<EnemyArchetype> archetypes;
+};
+
+#endif // ENEMYTABLE_H
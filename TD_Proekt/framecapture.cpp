@@ -0,0 +1,105 @@
+#include "framecapture.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutexLocker>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstdio>
+
+using namespace CAPTURE;
+
+//One core is left to the game thread, the encoders take the rest
+FrameCapture::FrameCapture(const QDir& dir, int intervalMs) : dir(dir), interval(intervalMs > 0 ? intervalMs : DEFAULT_INTERVAL_MS),
+    nextMs(-1), submitted(0), stalledNs(0), closing(false), written(0), failed(0)
+{
+    pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+    for(int i = 0; i < pool.maxThreadCount(); i++)
+        encoders.push_back(QtConcurrent::run(&pool, [this]{ encode(); }));
+}
+
+FrameCapture::~FrameCapture(){
+    finish();
+}
+
+//Returns once everything submitted is written, nothing may be submitted after it
+void FrameCapture::finish(){
+    {
+        QMutexLocker hold(&lock);
+        closing = true;
+        queued.wakeAll();
+    }
+    for(auto& e : encoders)
+        e.waitForFinished();
+}
+
+//The image to paint a due frame into. An encoder still holding the last one keeps it, the game thread
+//starts on a fresh one rather than copy it.
+QImage& FrameCapture::target(QSize deviceSize, qreal devicePixelRatio){
+    if(buffer.size() != deviceSize || !buffer.isDetached())
+        buffer = QImage(deviceSize, QImage::Format_ARGB32_Premultiplied);
+    buffer.setDevicePixelRatio(devicePixelRatio);
+    return buffer;
+}
+
+//Queues what was painted into target(), sharing its pixels with the encoder
+//Every interval passed since the last frame gets a file of its own, so the sequence keeps its timing at
+//4x and 16x where several intervals go by between two paints. Those files repeat the same picture.
+void FrameCapture::submit(qint64 simMs){
+    int copies = nextMs >= 0 && simMs >= nextMs ? (simMs - nextMs)/interval + 1 : 1;
+    nextMs = (simMs/interval + 1)*interval;
+
+    QMutexLocker hold(&lock);
+    if(int(frames.size()) >= QUEUE_FRAMES){
+        QElapsedTimer stall;
+        stall.start();
+        while(int(frames.size()) >= QUEUE_FRAMES)
+            taken.wait(&lock);
+        stalledNs += stall.nsecsElapsed();
+    }
+    frames.push_back(Frame(buffer, submitted, copies));
+    submitted += copies;
+    queued.wakeOne();
+}
+
+void FrameCapture::encode(){
+    QMutexLocker hold(&lock);
+    for(;;){
+        while(frames.empty() && !closing)
+            queued.wait(&lock);
+        if(frames.empty())
+            return;
+        Frame f = frames.front();
+        frames.pop_front();
+        taken.wakeOne();
+
+        //Repeats are encoded once and copied
+        hold.unlock();
+        QString first = fileName(f.number);
+        int saved = f.image.save(first, "PNG") ? 1 : 0;
+        f.image = QImage();
+        for(int c = 1; c < f.copies && saved == c; c++){
+            QFile::remove(fileName(f.number + c));
+            if(QFile::copy(first, fileName(f.number + c)))
+                saved++;
+        }
+        hold.relock();
+
+        written += saved;
+        failed += f.copies - saved;
+    }
+}
+
+QString FrameCapture::fileName(int number) const{
+    return dir.filePath(FILE_PATTERN.arg(number, NUMBER_WIDTH, 10, QChar('0')));
+}
+
+//Call after finish, the counts are only final then
+std::string FrameCapture::report() const{
+    char line[160];
+    std::snprintf(line, sizeof(line), "capture %d frames to %s, %d written, %d failed, %d encoders, %lld ms stalled",
+                  submitted, dir.absolutePath().toLocal8Bit().constData(), written, failed, pool.maxThreadCount(),
+                  (long long)(stalledNs/1000000));
+    return line;
+}
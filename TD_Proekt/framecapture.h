@@ -0,0 +1,73 @@
+#ifndef FRAMECAPTURE_H
+#define FRAMECAPTURE_H
+
+#include <QDir>
+#include <QFuture>
+#include <QImage>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <QtGlobal>
+#include <deque>
+#include <string>
+#include <vector>
+
+
+namespace CAPTURE{
+    const QString ARGUMENT = "--capture";
+    const int DEFAULT_INTERVAL_MS = 100;  //of simulated time, so a replay captures the same moments at any speed
+    const int QUEUE_FRAMES = 8;           //frames waiting for an encoder before submit blocks the game thread
+    const QString FILE_PATTERN = "frame_%1.png";  //numbered from 0 without gaps, as video encoders expect
+    const int NUMBER_WIDTH = 6;
+}
+
+//Writes the frames Game paints to numbered PNGs in a directory. Game renders a due frame into target()
+//instead of straight onto the widget, blits it and submits it. PNG encoding runs on a pool of its own,
+//fed through a bounded queue, so the game thread pays for that blit and nothing else unless the
+//encoders fall QUEUE_FRAMES behind, when submit waits for one to catch up.
+class FrameCapture
+{
+public:
+    FrameCapture(const QDir& dir, int intervalMs);
+    ~FrameCapture();
+
+    //A new game starts the clock over, which counts as due too
+    inline bool isDue(qint64 simMs) const { return nextMs < 0 || simMs >= nextMs || simMs < nextMs - interval; }
+    QImage& target(QSize deviceSize, qreal devicePixelRatio);
+    void submit(qint64 simMs);
+    void finish();
+
+    std::string report() const;
+private:
+    QDir dir;
+    int interval;
+    qint64 nextMs;     //simulated time the next frame is due at, -1 before the first
+    int submitted;
+    qint64 stalledNs;  //game thread time spent waiting for room in the queue
+    QImage buffer;
+
+    class Frame{
+    public:
+        Frame(const QImage& i, int n, int c) : image(i), number(n), copies(c) {}
+        QImage image;
+        int number;
+        int copies;  //files numbered from number on that show this image
+    };
+
+    QThreadPool pool;
+    std::vector<QFuture<void> > encoders;
+    QMutex lock;
+    QWaitCondition queued;
+    QWaitCondition taken;
+    std::deque<Frame> frames;
+    bool closing;
+    int written;
+    int failed;
+
+    void encode();
+    QString fileName(int number) const;
+};
+
+#endif // FRAMECAPTURE_H
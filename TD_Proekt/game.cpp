@@ -2,27 +2,82 @@
 #include "waypoint.h"
 #include "enemy.h"
 #include "wavegenerator.h"
+#include "savegame.h"
+#include "assets.h"
+#include "memorystats.h"
 
 #include <QApplication>
 #include <QPainter>
 #include <QKeyEvent>
 #include <QMouseEvent>
-#include <QTimer>
+#include <QWindow>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <cstdio>
+
+
+static const QString NORMAL_CHARS[] = {
+    CHARS::CHAR_0, CHARS::CHAR_1, CHARS::CHAR_2, CHARS::CHAR_3, CHARS::CHAR_4, CHARS::CHAR_5,
+    CHARS::CHAR_6, CHARS::CHAR_7, CHARS::CHAR_8, CHARS::CHAR_9, CHARS::CHAR_A, CHARS::CHAR_B,
+    CHARS::CHAR_C, CHARS::CHAR_D, CHARS::CHAR_E, CHARS::CHAR_F, CHARS::CHAR_G, CHARS::CHAR_H,
+    CHARS::CHAR_I, CHARS::CHAR_J, CHARS::CHAR_K, CHARS::CHAR_L, CHARS::CHAR_M, CHARS::CHAR_N,
+    CHARS::CHAR_O, CHARS::CHAR_P, CHARS::CHAR_Q, CHARS::CHAR_R, CHARS::CHAR_S, CHARS::CHAR_T,
+    CHARS::CHAR_U, CHARS::CHAR_V, CHARS::CHAR_W, CHARS::CHAR_X, CHARS::CHAR_Y, CHARS::CHAR_Z
+};
+static const QString ACTIVE_CHARS[] = {
+    CHARS::CHAR_0_ACT, CHARS::CHAR_1_ACT, CHARS::CHAR_2_ACT, CHARS::CHAR_3_ACT, CHARS::CHAR_4_ACT, CHARS::CHAR_5_ACT,
+    CHARS::CHAR_6_ACT, CHARS::CHAR_7_ACT, CHARS::CHAR_8_ACT, CHARS::CHAR_9_ACT, CHARS::CHAR_A_ACT, CHARS::CHAR_B_ACT,
+    CHARS::CHAR_C_ACT, CHARS::CHAR_D_ACT, CHARS::CHAR_E_ACT, CHARS::CHAR_F_ACT, CHARS::CHAR_G_ACT, CHARS::CHAR_H_ACT,
+    CHARS::CHAR_I_ACT, CHARS::CHAR_J_ACT, CHARS::CHAR_K_ACT, CHARS::CHAR_L_ACT, CHARS::CHAR_M_ACT, CHARS::CHAR_N_ACT,
+    CHARS::CHAR_O_ACT, CHARS::CHAR_P_ACT, CHARS::CHAR_Q_ACT, CHARS::CHAR_R_ACT, CHARS::CHAR_S_ACT, CHARS::CHAR_T_ACT,
+    CHARS::CHAR_U_ACT, CHARS::CHAR_V_ACT, CHARS::CHAR_W_ACT, CHARS::CHAR_X_ACT, CHARS::CHAR_Y_ACT, CHARS::CHAR_Z_ACT
+};
+static const QString RED_CHARS[] = {
+    CHARS::CHAR_0_RED, CHARS::CHAR_1_RED, CHARS::CHAR_2_RED, CHARS::CHAR_3_RED, CHARS::CHAR_4_RED, CHARS::CHAR_5_RED,
+    CHARS::CHAR_6_RED, CHARS::CHAR_7_RED, CHARS::CHAR_8_RED, CHARS::CHAR_9_RED
+};
+static const QString SPECIAL_CHARS[] = {
+    CHARS::CHAR_SPACE
+};
+
+static QStringList charPaths(){
+    QStringList paths;
+    for(const auto& c : NORMAL_CHARS)
+        paths.append(c);
+    for(const auto& c : ACTIVE_CHARS)
+        paths.append(c);
+    for(const auto& c : RED_CHARS)
+        paths.append(c);
+    for(const auto& c : SPECIAL_CHARS)
+        paths.append(c);
+    return paths;
+}
 
 
-Game::Game(QWidget *parent) : QWidget(parent) , state(MENU), helpIndex(0) , curTowerOpt(0), curTowerType(FIRE), wave_value(0), score_value(10) ,
-    enemyCount(0), generator(SEED), damageDisplayOffset(-2,2), tooltip(NULL)
+Game::Game(QWidget *parent) : QWidget(parent) , state(MENU), helpIndex(0) , curTowerOpt(0), curTowerType(FIRE),
+    paintTimer(0), scenario(NULL), hashLog(NULL), stateHash(STATEHASH::OFFSET), capture(NULL), speedIndex(0), tickDebt(0), ticksThisSecond(0), ticksPerSecond(0),
+    viewport(CONSTANTS::SCREEN_WIDTH, CONSTANTS::SCREEN_HEIGHT), hoverTimer(0), hovered(HIT_NONE), selectedTile(-1),
+    generator(SEED), damageDisplayOffset(-2,2), tooltip(NULL), helpLoaded(false), pauseLoaded(false), inGameLoaded(false),
+    firstFrameReported(false), showDebug(false)
 {
+    startupClock.start();
     setWindowTitle("Tower Defence");
-    setFixedSize(CONSTANTS::SCREEN_WIDTH, CONSTANTS::SCREEN_HEIGHT);
+    setMinimumSize(CONSTANTS::SCREEN_WIDTH/2, CONSTANTS::SCREEN_HEIGHT/2);
+    resize(CONSTANTS::SCREEN_WIDTH, CONSTANTS::SCREEN_HEIGHT);
 
     setMouseTracking(true);
 
+    //Only the menu has to be built before the first frame. Everything is queued for decoding at once, the
+    //glyphs first, and the other screens are built from the decoded images the first time they are shown.
+    Assets::prefetch(charPaths());
+    Assets::prefetch(QStringList{CONSTANTS::LEFT_PATH, CONSTANTS::LEFT_H_PATH, CONSTANTS::RIGHT_PATH, CONSTANTS::RIGHT_H_PATH,
+                                 CONSTANTS::HELP_SELECT_TOWER, CONSTANTS::HELP_UPGRADE, CONSTANTS::HELP_BUILD_TOWER});
+    Assets::prefetch(QStringList{CONSTANTS::DIRT_TILE, CONSTANTS::GRASS_TILE, CONSTANTS::HIGHLIGHT_TILE, CONSTANTS::TOWEROPT_H,
+                                 CONSTANTS::UPGRADE_STRENGTH, CONSTANTS::UPGRADE_RANGE, CONSTANTS::UPGRADE_RATE, TOOLTIP::BASE});
+
     fillCharReferences();
     loadMenu();
-    loadHelp();
-    loadPause();
-    loadInGame();
 }
 
 Game::~Game()
@@ -32,6 +87,13 @@ Game::~Game()
     cleanPause();
     cleanInGame();
     cleanCharReferences();
+    delete scenario;
+    delete hashLog;
+    if(capture != NULL){
+        capture->finish();
+        qInfo() << capture->report().c_str();
+    }
+    delete capture;
 }
 
 void Game::cleanCharReferences(){
@@ -43,145 +105,274 @@ void Game::cleanCharReferences(){
         delete c;
     for(auto& c : specialChars)
         delete c;
+    for(auto& m : mergedChars)
+        delete m.second;
+    mergedChars.clear();
 }
 
 void Game::paintEvent(QPaintEvent*){
+    QElapsedTimer frameTime;
+    frameTime.start();
     QPainter painter(this);
+    viewport.resize(size(), devicePixelRatioF());
+    schedule();
+    load.sample();
+    if(!firstFrameReported){
+        firstFrameReported = true;
+        qInfo() << "first frame after" << startupClock.elapsed() << "ms";
+    }
 
     switch(state){
         case MENU:
-            painter.drawImage(*title_line1->getRect(), *title_line1->getImage());
-            painter.drawImage(*title_line2->getRect(), *title_line2->getImage());
+            viewport.draw(LAYER_HUD, *title_line1->getRect(), *title_line1->getImage());
+            viewport.draw(LAYER_HUD, *title_line2->getRect(), *title_line2->getImage());
 
             if(start_button->isActive())
-                painter.drawImage(*start_button->getRect(), start_button->getActiveImage());
+                viewport.draw(LAYER_HUD, *start_button->getRect(), start_button->getActiveImage());
             else
-                painter.drawImage(*start_button->getRect(), *start_button->getImage());
+                viewport.draw(LAYER_HUD, *start_button->getRect(), *start_button->getImage());
+
+            if(load_button->isActive())
+                viewport.draw(LAYER_HUD, *load_button->getRect(), load_button->getActiveImage());
+            else
+                viewport.draw(LAYER_HUD, *load_button->getRect(), *load_button->getImage());
 
             if(help_button->isActive())
-                painter.drawImage(*help_button->getRect(), help_button->getActiveImage());
+                viewport.draw(LAYER_HUD, *help_button->getRect(), help_button->getActiveImage());
+            else
+                viewport.draw(LAYER_HUD, *help_button->getRect(), *help_button->getImage());
+            if(stress_button->isActive())
+                viewport.draw(LAYER_HUD, *stress_button->getRect(), stress_button->getActiveImage());
             else
-                painter.drawImage(*help_button->getRect(), *help_button->getImage());
+                viewport.draw(LAYER_HUD, *stress_button->getRect(), *stress_button->getImage());
             if(quit_button->isActive())
-                painter.drawImage(*quit_button->getRect(), quit_button->getActiveImage());
+                viewport.draw(LAYER_HUD, *quit_button->getRect(), quit_button->getActiveImage());
             else
-                painter.drawImage(*quit_button->getRect(), *quit_button->getImage());
+                viewport.draw(LAYER_HUD, *quit_button->getRect(), *quit_button->getImage());
             break;
         case INGAME:
-            paintChar(std::to_string(getWave()),1,painter,10,10+wave_title->getRect()->height(),false);
-            painter.drawImage(*score_title->getRect(),*score_title->getImage());
-            paintChar(std::to_string(getScore()),1,painter,width()-std::to_string(getScore()).length()*6-5, 10+score_title->getRect()->height(),false);
-            painter.drawImage(*wave_title->getRect(),*wave_title->getImage());
+            paintChar(std::to_string(getWave()),1,10,10+wave_title->getRect()->height(),false);
+            viewport.draw(LAYER_HUD, *score_title->getRect(),*score_title->getImage());
+            paintChar(std::to_string(getScore()),1,CONSTANTS::SCREEN_WIDTH-std::to_string(getScore()).length()*6-5, 10+score_title->getRect()->height(),false);
+            viewport.draw(LAYER_HUD, *wave_title->getRect(),*wave_title->getImage());
 
             for(const auto o : towerOptions)
-                painter.drawImage(*o->getRect(), *o->getImage());
-            painter.drawImage(*towerOptions[curTowerOpt]->getRect(), *towerOptHighlight->getImage());
+                viewport.draw(LAYER_HUD, *o->getRect(), *o->getImage());
+            viewport.draw(LAYER_HUD_TOP, *towerOptions[curTowerOpt]->getRect(), *towerOptHighlight->getImage());
 
-            switch(curTowerOpt){
-                case 0:
-                    for(auto& u : fire_upgrade)
-                        painter.drawImage(*u->getRect(), *u->getImage());
-                    break;
-                case 1:
-                    for(auto& u : ice_upgrade)
-                        painter.drawImage(*u->getRect(), *u->getImage());
-                    break;
-                case 2:
-                    for(auto& u : earth_upgrade)
-                        painter.drawImage(*u->getRect(), *u->getImage());
-                    break;
+            for(auto& i : upgrade_icon){
+                viewport.draw(LAYER_HUD, *i->getRect(), *upgrade_base[curTowerOpt]->getImage());
+                viewport.draw(LAYER_HUD_TOP, *i->getRect(), *i->getImage());
             }
 
-            for(auto& i : upgrade_icon)
-                painter.drawImage(*i->getRect(), *i->getImage());
-
-            for(auto& t : map){
-                painter.drawImage(*t->getRect(), *t->getImage());
-                if(t->isActive())
-                    painter.drawImage(*tileHighlight->getRect(), *tileHighlight->getImage());
-            }
+            for(auto& t : map)
+                viewport.draw(LAYER_GROUND, *t->getRect(), *t->getImage());
+            if(selectedTile >= 0)
+                viewport.draw(LAYER_GROUND_TOP, *tileHighlight->getRect(), *tileHighlight->getImage());
 
-            for(auto& e : enemies){
+            for(const auto e : sim.getEnemies()){
                 if(!e->isDead())
-                    painter.drawImage(*e->getRect(), *e->getImage());
+                    viewport.draw(LAYER_UNITS, *e->getRect(), e->getSheet().getImage(), e->getFrame(), e->isMirrored());
             }
 \
-            for(const auto t : towers)
-                painter.drawImage(*t->getRect(), *t->getImage());
+            for(const auto t : sim.getTowers())
+                viewport.draw(LAYER_UNITS, *t->getRect(), *t->getImage());
+
+            for(int i = 0; i < sim.getProjectiles().size(); i++){
+                const QImage& p = TowerTable::get(sim.getProjectiles().getType(i)).projectile;
+                viewport.draw(LAYER_EFFECTS, QPointF(sim.getProjectiles().getX(i) - p.width()/2, sim.getProjectiles().getY(i) - p.height()/2), p);
+            }
 
             for(const auto d : damageDisplays)
-                painter.drawImage(*d->getRect(), *d->getImage());
+                viewport.draw(LAYER_EFFECTS, *d->getRect(), *d->getImage());
 
             if(tooltip != NULL)
-                tooltip->paint(&painter);
+                tooltip->paint(viewport);
+
+            paintChar("x"+std::to_string(SIM::SPEEDS[speedIndex]),1,10,CONSTANTS::SCREEN_HEIGHT-20,false);
+            if(showDebug){
+                paintChar(std::to_string(ticksPerSecond)+" tps "+std::to_string(viewport.getDrawCalls())+" draws",1,10,CONSTANTS::SCREEN_HEIGHT-35,false);
+                paintChar(std::to_string(load.getCpuPercent())+" cpu "+std::to_string(load.getWakeupsPerSecond())+" wakeups",1,10,CONSTANTS::SCREEN_HEIGHT-50,false);
+                paintChar(MemoryStats::report(MemoryStats::GAME_OBJECTS, MemoryStats::ENEMIES),1,10,CONSTANTS::SCREEN_HEIGHT-65,false);
+                paintChar(MemoryStats::report(MemoryStats::ATLAS, MemoryStats::DECODED),1,10,CONSTANTS::SCREEN_HEIGHT-80,false);
+                paintChar(MemoryStats::report(MemoryStats::BUNDLE, MemoryStats::BUNDLE)+" heap "+std::to_string(MemoryStats::getHeapBytes()/1024)+"kb",1,10,CONSTANTS::SCREEN_HEIGHT-95,false);
+            }
             break;
         case CLEARED:
-            paintChar("wave "+std::to_string(getWave())+" cleared",0.25,painter,(width()-(13+std::to_string(getWave()).length())*20)/2,100,false);
+            paintChar("wave "+std::to_string(getWave())+" cleared",ASSETS::BUTTON_SCALE,(CONSTANTS::SCREEN_WIDTH-(13+std::to_string(getWave()).length())*20)/2,100,false);
             if(continue_button->isActive())
-                painter.drawImage(*continue_button->getRect(), continue_button->getActiveImage());
+                viewport.draw(LAYER_HUD, *continue_button->getRect(), continue_button->getActiveImage());
             else
-                painter.drawImage(*continue_button->getRect(), *continue_button->getImage());
+                viewport.draw(LAYER_HUD, *continue_button->getRect(), *continue_button->getImage());
             break;
         case PAUSED:
             for(const auto b : pauseButtons){
                 if(b->isActive())
-                    painter.drawImage(*b->getRect(), b->getActiveImage());
+                    viewport.draw(LAYER_HUD, *b->getRect(), b->getActiveImage());
                 else
-                    painter.drawImage(*b->getRect(), *b->getImage());
+                    viewport.draw(LAYER_HUD, *b->getRect(), *b->getImage());
             }
             break;
         case HELP:
-            painter.drawImage(*helpImages[helpIndex]->getRect(), *helpImages[helpIndex]->getImage());
+            viewport.draw(LAYER_HUD, *helpImages[helpIndex]->getRect(), *helpImages[helpIndex]->getImage());
 
             for(const auto b : arrows){
                 if(b->isActive())
-                    painter.drawImage(*b->getRect(), b->getActiveImage());
+                    viewport.draw(LAYER_HUD_TOP, *b->getRect(), b->getActiveImage());
                 else
-                    painter.drawImage(*b->getRect(), *b->getImage());
+                    viewport.draw(LAYER_HUD_TOP, *b->getRect(), *b->getImage());
             }
             break;
     }
+    //A due capture is painted offscreen and shown from there, which costs this thread one extra blit
+    qint64 simMs = sim.getTick()*SIM::TICK_MS;
+    if(capture != NULL && state == INGAME && capture->isDue(simMs)){
+        QImage& frame = capture->target(size()*devicePixelRatioF(), devicePixelRatioF());
+        frame.fill(palette().color(QPalette::Window));
+        QPainter offscreen(&frame);
+        viewport.flush(offscreen);
+        offscreen.end();
+        painter.drawImage(QPoint(0, 0), frame);
+        capture->submit(simMs);
+    }
+    else
+        viewport.flush(painter);
+    if(scenario != NULL && state == INGAME)
+        scenario->recordFrame(frameTime.nsecsElapsed());
 }
 
 void Game::timerEvent(QTimerEvent *event){
-    if(state == INGAME){
-        if(event->timerId() == spawnTimer)
-            spawner();
+    if(event->timerId() == hoverTimer){
+        killTimer(hoverTimer);
+        hoverTimer = 0;
+        hover();
+        return;
+    }
+    if(event->timerId() != paintTimer)
+        return;
+    //Occlusion has no event of its own, the next expose paints and restarts the timer
+    if(windowHandle() != NULL && !windowHandle()->isExposed()){
+        schedule();
+        return;
     }
-    repaint();
+    advance();
+    update();
 }
 
-void Game::spawner(){
-    killTimer(spawnTimer);
+bool Game::event(QEvent* event){
+    load.wake();
+    return QWidget::event(event);
+}
 
-    if(!spawnList.empty()){
-        enemies.push_back(spawnList.back());
-        spawnTimer = startTimer(spawnList.back()->getSpawnDelay());
-        spawnList.pop_back();
-    }
+void Game::changeEvent(QEvent* event){
+    if(event->type() == QEvent::WindowStateChange)
+        schedule();
+    QWidget::changeEvent(event);
 }
 
-void Game::moveEnemies(){
-    for(auto& e : enemies){
-        if(e->getRect()->contains(navPath[CONSTANTS::PATH_TILE_COUNT - 1].toPoint())){
-            state = MENU;
-            break;
-        }
-        if(e->getRect()->contains(navPath[e->getCurWaypoint()+1].toPoint()))
-        {
-            e->incrementCurWaypoint();
+void Game::showEvent(QShowEvent* event){
+    schedule();
+    QWidget::showEvent(event);
+}
+
+void Game::hideEvent(QHideEvent* event){
+    schedule();
+    QWidget::hideEvent(event);
+}
+
+//Runs every tick the elapsed real time owes at the current speed, the frame is painted once afterwards
+void Game::advance(){
+    //A scenario runs a fixed number of ticks per frame, so what it simulates doesn't depend on the frame rate
+    if(scenario != NULL)
+        tickDebt += SIM::SPEEDS[speedIndex];
+    else
+        tickDebt += frameClock.restart() * SIM::SPEEDS[speedIndex] / double(SIM::TICK_MS);
+    //When the CPU can't keep up the game slows down instead of piling up ticks it will never catch up on
+    if(tickDebt > SIM::MAX_TICKS_PER_FRAME)
+        tickDebt = SIM::MAX_TICKS_PER_FRAME;
+
+    while(tickDebt >= 1 && state == INGAME){
+        QElapsedTimer tickTime;
+        tickTime.start();
+        tick();
+        if(hashLog != NULL)
+            logStateHash();
+        if(scenario != NULL){
+            scenario->recordTick(tickTime.nsecsElapsed());
+            if(scenario->isDone())
+                finishScenario();
         }
-        e->move(navPath[e->getCurWaypoint()+1]);
+        tickDebt--;
+        ticksThisSecond++;
+    }
+
+    if(rateClock.elapsed() >= 1000){
+        ticksPerSecond = ticksThisSecond * 1000 / rateClock.restart();
+        ticksThisSecond = 0;
+    }
+}
+
+void Game::tick(){
+    sim.tick();
+    if(sim.getOutcome() == Simulation::LOST){
+        QFile::remove(SaveGame::defaultPath()); //The run is lost, there is nothing left to resume
+        setState(MENU);
+        return;
+    }
+    animateEnemies();
+    moveDecals();
+    addDecals();
+    if(sim.getOutcome() == Simulation::WAVE_CLEARED)
+        setState(CLEARED);
+}
+
+//Frames are shared through each archetype's sheet, only the per-enemy index and timer change here
+void Game::animateEnemies(){
+    for(auto& e : sim.getEnemies())
+        e->animate(SIM::TICK_MS);
+}
+
+void Game::moveDecals(){
+    while(!damageExpiry.empty() && damageExpiry.front() <= sim.getTick()){
+        delete damageDisplays.front();
+        damageDisplays.pop_front();
+        damageExpiry.pop_front();
     }
+    if(sim.getTick() % SIM::toTicks(SIM::DECAL_RISE_MS) == 0)
+        for(auto& d : damageDisplays)
+            d->getRect()->translate(0,-1);
+}
+
+//A rising damage number for every hit of the last tick
+void Game::addDecals(){
+    for(const auto& h : sim.getHits()){
+        Image* decal = mergeChars(std::to_string(h.damage),1,RED);
+        decal->getRect()->moveTo(h.at.x()+damageDisplayOffset(generator), h.at.y());
+        damageDisplays.push_back(decal);
+        damageExpiry.push_back(sim.getTick() + SIM::toTicks(SIM::DECAL_LIFE_MS));
+    }
+}
+
+void Game::cycleSpeed(){
+    speedIndex = (speedIndex + 1) % SIM::SPEED_COUNT;
 }
 
 void Game::keyPressEvent(QKeyEvent* event){
     if(state == INGAME){
         switch(event->key()){
             case Qt::Key_P:
-                    state = PAUSED;
+                    loadPause();
+                    setState(PAUSED);
+                    break;
+            case Qt::Key_F:
+                    cycleSpeed();
+                    break;
+            case Qt::Key_M:
+                    showDebug = !showDebug;
+                    update();
                     break;
             case Qt::Key_Escape:
+                    saveGame();
                     qApp->exit();
                     break;
             default:
@@ -192,446 +383,503 @@ void Game::keyPressEvent(QKeyEvent* event){
         QWidget::keyPressEvent(event);
 }
 
+//Moves only record the position, however many arrive in a frame hover() looks at the latest one once
 void Game::mouseMoveEvent(QMouseEvent *event){
-    switch(state){
-        case MENU:
-            if(start_button->getRect()->contains(event->pos())){
-                start_button->setActive(true);
-                help_button->setActive(false);
-                quit_button->setActive(false);
-            }
-            else if(help_button->getRect()->contains(event->pos())){
-                help_button->setActive(true);
-                start_button->setActive(false);
-                quit_button->setActive(false);
-            }
-            else if(quit_button->getRect()->contains(event->pos())){
-                quit_button->setActive(true);
-                start_button->setActive(false);
-                help_button->setActive(false);
-            }
-            else{
-                start_button->setActive(false);
-                help_button->setActive(false);
-                quit_button->setActive(false);
-            }
-            break;
-        case PAUSED:
-            if(pauseButtons[0]->getRect()->contains(event->pos())){
-                pauseButtons[0]->setActive(true);
-                pauseButtons[1]->setActive(false);
-            }
-            else if(pauseButtons[1]->getRect()->contains(event->pos())){
-                pauseButtons[0]->setActive(false);
-                pauseButtons[1]->setActive(true);
-            }
-            else{
-                pauseButtons[0]->setActive(false);
-                pauseButtons[1]->setActive(false);
-            }
-            break;
-        case HELP:
-            if(arrows[0]->getRect()->contains(event->pos())){
-                arrows[0]->setActive(true);
-                arrows[1]->setActive(false);
-                arrows[2]->setActive(false);
-            }
-            else if(arrows[1]->getRect()->contains(event->pos())){
-                arrows[0]->setActive(false);
-                arrows[1]->setActive(true);
-                arrows[2]->setActive(false);
-            }
-            else if(arrows[2]->getRect()->contains(event->pos())){
-                arrows[0]->setActive(false);
-                arrows[1]->setActive(false);
-                arrows[2]->setActive(true);
-            }
-            else{
-                arrows[0]->setActive(false);
-                arrows[1]->setActive(false);
-                arrows[2]->setActive(false);
-            }
-            break;
-        case CLEARED:
-            if(continue_button->getRect()->contains(event->pos()))
-                continue_button->setActive(true);
-            else
-                continue_button->setActive(false);
-            break;
-        case INGAME:
-            delete tooltip;
-            tooltip = NULL;
+    mousePos = viewport.toLogical(event->pos());
+    if(hoverTimer == 0)
+        hoverTimer = startTimer(SIM::FRAME_MS);
+}
 
-            if(towerOptions[0]->getRect()->contains(event->pos())){
-                tooltip = new ToolTip(mergeChars("cost", 1, NORMAL),
-                                      mergeChars(std::to_string(Tower::getCost(FIRE)), 1, ACTIVE));
-                tooltip->moveTo(event->pos());
-            }
+//Updates highlights and the tooltip for the cursor, repainting only what they cover
+void Game::hover(){
+    int hit = hitGrids[state].at(mousePos);
+    if(hit != hovered){
+        Button* b = buttonFor(hovered);
+        if(b != NULL)
+            b->setActive(false);
+        markDirty(hoveredRect);
+
+        hovered = hit;
+        hoveredRect = hitGrids[state].getRect(hit);
+        b = buttonFor(hovered);
+        if(b != NULL)
+            b->setActive(true);
+        markDirty(hoveredRect);
+
+        if(state == INGAME)
+            showTooltip(tooltipFor(hit));
+    }
+    else if(tooltip != NULL){
+        markDirty(tooltip->getRect());
+        tooltip->moveTo(mousePos);
+        markDirty(tooltip->getRect());
+    }
+}
 
-            else if(towerOptions[1]->getRect()->contains(event->pos())){
-                tooltip = new ToolTip(mergeChars("cost", 1, NORMAL),
-                                      mergeChars(std::to_string(Tower::getCost(ICE)), 1, ACTIVE));
-                tooltip->moveTo(event->pos());
-            }
+Button* Game::buttonFor(int hit){
+    switch(hit){
+        case HIT_START:
+            return start_button;
+        case HIT_LOAD:
+            return load_button;
+        case HIT_HELP:
+            return help_button;
+        case HIT_STRESS:
+            return stress_button;
+        case HIT_QUIT:
+            return quit_button;
+        case HIT_RESUME:
+            return pauseButtons[0];
+        case HIT_MAIN_MENU:
+            return pauseButtons[1];
+        case HIT_PREV:
+            return arrows[0];
+        case HIT_NEXT:
+            return arrows[1];
+        case HIT_BACK:
+            return arrows[2];
+        case HIT_CONTINUE:
+            return continue_button;
+        default:
+            return NULL;
+    }
+}
 
-            else if(towerOptions[2]->getRect()->contains(event->pos())){
-                tooltip = new ToolTip(mergeChars("cost", 1, NORMAL),
-                                      mergeChars(std::to_string(Tower::getCost(EARTH)), 1, ACTIVE));
-                tooltip->moveTo(event->pos());
-            }
+Game::ToolTip* Game::tooltipFor(int hit){
+    switch(hit){
+        case HIT_UPGRADE_DAMAGE:
+            return new ToolTip(mergeChars("cost", 1, NORMAL),
+                               mergeChars(std::to_string(getUpgrades().getDamageCost(curTowerType)), 1, ACTIVE),
+                               mergeChars("str", 1, NORMAL),
+                               mergeChars(std::to_string(getUpgrades().getDamage(curTowerType)), 1, ACTIVE));
+        case HIT_UPGRADE_RANGE:
+            return new ToolTip(mergeChars("cost", 1, NORMAL),
+                               mergeChars(std::to_string(getUpgrades().getRangeCost(curTowerType)), 1, ACTIVE),
+                               mergeChars("range", 1, NORMAL),
+                               mergeChars(std::to_string(getUpgrades().getRange(curTowerType)), 1, ACTIVE));
+        case HIT_UPGRADE_RATE:
+            return new ToolTip(mergeChars("cost", 1, NORMAL),
+                               mergeChars(std::to_string(getUpgrades().getCoolDownCost(curTowerType)), 1, ACTIVE),
+                               mergeChars("rate", 1, NORMAL),
+                               mergeChars(std::to_string(getUpgrades().getCoolDown(curTowerType)), 1, ACTIVE));
+    }
+    if(hit >= HIT_TOWER)
+        return new ToolTip(mergeChars("target", 1, NORMAL),
+                           mergeChars(Tower::getTargetingName(sim.getTowers()[hit - HIT_TOWER]->getTargeting()), 1, ACTIVE));
+    if(hit >= HIT_TOWER_OPTION)
+        return new ToolTip(mergeChars("cost", 1, NORMAL),
+                           mergeChars(std::to_string(getUpgrades().getCost(static_cast<Type>(hit - HIT_TOWER_OPTION))), 1, ACTIVE));
+    return NULL;
+}
 
-            if(upgrade_icon[0]->getRect()->contains(event->pos())){
-                tooltip = new ToolTip(mergeChars("cost", 1, NORMAL),
-                                      mergeChars(std::to_string(Tower::getDamageCost(curTowerType)), 1, ACTIVE),
-                                      mergeChars("str", 1, NORMAL),
-                                      mergeChars(std::to_string(Tower::getDamage(curTowerType)), 1, ACTIVE));
-                tooltip->moveTo(event->pos());
-            }
-            else if(upgrade_icon[1]->getRect()->contains(event->pos())){
-                tooltip = new ToolTip(mergeChars("cost", 1, NORMAL),
-                                      mergeChars(std::to_string(Tower::getRangeCost(curTowerType)), 1, ACTIVE),
-                                      mergeChars("range", 1, NORMAL),
-                                      mergeChars(std::to_string(Tower::getRange(curTowerType)), 1, ACTIVE));
-                tooltip->moveTo(event->pos());
-            }
-            else if(upgrade_icon[2]->getRect()->contains(event->pos())){
-               tooltip = new ToolTip(mergeChars("cost", 1, NORMAL),
-                                      mergeChars(std::to_string(Tower::getCoolDownCost(curTowerType)), 1, ACTIVE),
-                                      mergeChars("rate", 1, NORMAL),
-                                      mergeChars(std::to_string(Tower::getCoolDown(curTowerType)), 1, ACTIVE));
-                tooltip->moveTo(event->pos());
-            }
-            break;
+//Replaces the tooltip, NULL just hides it
+void Game::showTooltip(ToolTip* t){
+    if(tooltip != NULL)
+        markDirty(tooltip->getRect());
+    delete tooltip;
+    tooltip = t;
+    if(tooltip != NULL){
+        tooltip->moveTo(mousePos);
+        markDirty(tooltip->getRect());
     }
-    repaint();
+}
+
+void Game::markDirty(const QRect& logical){
+    if(!logical.isEmpty())
+        update(viewport.toWidget(logical));
 }
 
 void Game::mousePressEvent(QMouseEvent *event){
+    mousePos = viewport.toLogical(event->pos());
+    int hit = hitGrids[state].at(mousePos);
     switch(state){
         case MENU:
-            if(start_button->getRect()->contains(event->pos())){
-                state = INGAME;
+            if(hit == HIT_START){
                 newGame();
+                setState(INGAME);
+            }
+            else if(hit == HIT_LOAD){
+                loadGame();
             }
-            else if(help_button->getRect()->contains(event->pos())){
-                state = HELP;
+            else if(hit == HIT_HELP){
+                loadHelp();
+                setState(HELP);
             }
-            else if(quit_button->getRect()->contains(event->pos())){
+            else if(hit == HIT_STRESS){
+                runScenario(Scenario());
+            }
+            else if(hit == HIT_QUIT){
                 qApp->quit();
             }
             break;
         case PAUSED:
-            if(pauseButtons[0]->getRect()->contains(event->pos())){
-                state = INGAME;
-                startTimers();
-
+            if(hit == HIT_RESUME){
+                setState(INGAME);
             }
-            else if(pauseButtons[1]->getRect()->contains(event->pos())){
-                killTimer(paintTimer);
-                state = MENU;
+            else if(hit == HIT_MAIN_MENU){
+                saveGame();
+                setState(MENU);
             }
             break;
         case HELP:
-            if(arrows[0]->getRect()->contains(event->pos())){
+            if(hit == HIT_PREV){
                 if(helpIndex == 0)
                     helpIndex = helpImages.size()-1;
                 else
                     helpIndex--;
             }
-            else if(arrows[1]->getRect()->contains(event->pos())){
+            else if(hit == HIT_NEXT){
                 if(helpIndex == helpImages.size()-1)
                     helpIndex = 0;
                 else
                     helpIndex++;
             }
-            else if(arrows[2]->getRect()->contains(event->pos())){
+            else if(hit == HIT_BACK){
                 helpIndex = 0;
-                state = MENU;
+                setState(MENU);
             }
-            repaint();
             break;
     case INGAME:
-        for(auto& t : map)
-            (!t->isPath() && !t->isOccupied() && t->getRect()->contains(event->pos())) ? selectTile(t) : t->setActive(false);
-
-        for(size_t i=0; i<towerOptions.size(); i++){
-            if(towerOptions[i]->getRect()->contains(event->pos())){
-                curTowerOpt = i;
-                switch(curTowerOpt){
-                    case 0:
-                        curTowerType = FIRE;
-                        break;
-                    case 1:
-                        curTowerType = ICE;
-                        break;
-                    case 2:
-                        curTowerType = EARTH;
-                        break;
-                }
-            }
+        if(hit >= HIT_TOWER){
+            sim.getTowers()[hit - HIT_TOWER]->cycleTargeting();
+        }
+
+        selectTile(sim.getTiles().at(mousePos));
+
+        if(hit >= HIT_TOWER_OPTION && hit < HIT_TOWER){
+            curTowerOpt = hit - HIT_TOWER_OPTION;
+            curTowerType = static_cast<Type>(curTowerOpt);
         }
 
-        if(getScore() > Tower::getDamageCost(curTowerType) && upgrade_icon[0]->getRect()->contains(event->pos())){
-            updateScore(-Tower::getDamageCost(curTowerType));
-            Tower::upgradeDamage(curTowerType);
-            tooltip = new ToolTip(mergeChars("cost", 1, NORMAL),
-                                  mergeChars(std::to_string(Tower::getDamageCost(curTowerType)), 1, ACTIVE),
-                                  mergeChars("str", 1, NORMAL),
-                                  mergeChars(std::to_string(Tower::getDamage(curTowerType)), 1, ACTIVE));
-            tooltip->moveTo(event->pos());
+        if(hit == HIT_UPGRADE_DAMAGE && getScore() > getUpgrades().getDamageCost(curTowerType)){
+            updateScore(-getUpgrades().getDamageCost(curTowerType));
+            getUpgrades().upgradeDamage(curTowerType);
         }
-        else if(getScore() > Tower::getRangeCost(curTowerType) && upgrade_icon[1]->getRect()->contains(event->pos())){
-            updateScore(-Tower::getRangeCost(curTowerType));
-            Tower::upgradeRange(curTowerType);
-            tooltip = new ToolTip(mergeChars("cost", 1, NORMAL),
-                                  mergeChars(std::to_string(Tower::getRangeCost(curTowerType)), 1, ACTIVE),
-                                  mergeChars("range", 1, NORMAL),
-                                  mergeChars(std::to_string(Tower::getRange(curTowerType)), 1, ACTIVE));
-            tooltip->moveTo(event->pos());
+        else if(hit == HIT_UPGRADE_RANGE && getScore() > getUpgrades().getRangeCost(curTowerType)){
+            updateScore(-getUpgrades().getRangeCost(curTowerType));
+            getUpgrades().upgradeRange(curTowerType);
         }
-        else if(getScore() > Tower::getCoolDownCost(curTowerType) && upgrade_icon[2]->getRect()->contains(event->pos())){
-            updateScore(-Tower::getCoolDownCost(curTowerType));
-            Tower::upgradeCoolDown(curTowerType);
-            tooltip = new ToolTip(mergeChars("cost", 1, NORMAL),
-                                  mergeChars(std::to_string(Tower::getCoolDownCost(curTowerType)), 1, ACTIVE),
-                                  mergeChars("rate", 1, NORMAL),
-                                  mergeChars(std::to_string(Tower::getCoolDown(curTowerType)), 1, ACTIVE));
-            tooltip->moveTo(event->pos());
+        else if(hit == HIT_UPGRADE_RATE && getScore() > getUpgrades().getCoolDownCost(curTowerType)){
+            updateScore(-getUpgrades().getCoolDownCost(curTowerType));
+            getUpgrades().upgradeCoolDown(curTowerType);
         }
 
         break;
     case CLEARED:
-        if(continue_button->getRect()->contains(event->pos())){
-            newWave(); //start next wave
-            state = INGAME;
+        if(hit == HIT_CONTINUE){
+            sim.newWave(); //start next wave
+            setState(INGAME);
         }
         break;
     }
+    //A click can change the screen or what the hovered element shows, so hover is evaluated afresh
+    Button* b = buttonFor(hovered);
+    if(b != NULL)
+        b->setActive(false);
+    hovered = HIT_NONE;
+    hover();
+    update();
+}
+
+//Replaces whatever is going on with a stress run, see Scenario
+void Game::runScenario(const Scenario& s){
+    newGame();
+    delete scenario;
+    scenario = new Scenario(s);
+    generator.seed(SCENARIO::RANDOM_SEED);
+    sim.seed(SCENARIO::RANDOM_SEED);
+
+    TileGrid& tiles = sim.getTiles();
+    for(int t = tiles.nextBuildable(0); t >= 0; t = tiles.nextBuildable(t+1))
+        addTower(new Tower(static_cast<Type>(sim.getTowers().size() % Tower::getTypeCount()), tiles.rectOf(t)));
+    sim.startStress(s.getEnemies());
+    setState(INGAME);
+}
+
+bool Game::openHashLog(const QString& filePath){
+    hashLog = new QFile(filePath);
+    if(hashLog->open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return true;
+    qWarning() << "can't write" << filePath;
+    delete hashLog;
+    hashLog = NULL;
+    return false;
+}
+
+bool Game::openCapture(const QString& dirPath, int intervalMs){
+    QDir dir(dirPath);
+    if(!dir.mkpath(".")){
+        qWarning() << "can't create" << dirPath;
+        return false;
+    }
+    capture = new FrameCapture(dir, intervalMs);
+    return true;
+}
+
+//Folds everything a tick can change into the running hash and logs it as "tick hash". Each line depends on
+//every tick before it, so diffing the logs of two runs finds the first tick they simulated differently.
+void Game::logStateHash(){
+    StateHash h(stateHash);
+    h.add(int(state));
+    sim.hash(h);
+    stateHash = h.get();
+    char line[48];
+    std::snprintf(line, sizeof(line), "%lld %016llx\n", (long long)sim.getTick(), (unsigned long long)stateHash);
+    hashLog->write(line);
+}
+
+void Game::finishScenario(){
+    qInfo() << scenario->report().c_str();
+    bool quit = scenario->isQuitWhenDone();
+    clearGame();
+    setState(MENU);
+    if(quit)
+        qApp->quit();
 }
 
 void Game::newGame(){
+    loadInGame();
     clearGame();
-    wave_value = 0;
-    newWave();
-    score_value = 20;
-    paintTimer = startTimer(10);
+    sim.newWave();
+    sim.setScore(20);
 }
 
-void Game::startTimers(){
-    QTimer::singleShot(30,this,SLOT(moveEvent()));
-    QTimer::singleShot(150,this,SLOT(moveDecals()));
-    QTimer::singleShot(30,this,SLOT(collisionEvent()));
+void Game::setState(State s){
+    //Leaving a stress run early abandons it
+    if(s == MENU && scenario != NULL){
+        delete scenario;
+        scenario = NULL;
+    }
+    state = s;
+    schedule();
+    update();
 }
 
-void Game::newWave(){
-    updateWave();
-    for(auto& e : enemies)
-        delete e;
-    enemies.clear();
+//Only the game screen moves on its own, and only while it can be seen. Every other screen is painted
+//on demand through update(), so an idle, minimized or covered window gets no timer wakeups at all.
+void Game::schedule(){
+    bool animate = state == INGAME && isVisible() && !isMinimized() && (windowHandle() == NULL || windowHandle()->isExposed());
+    if(animate && paintTimer == 0){
+        paintTimer = startTimer(SIM::FRAME_MS, Qt::PreciseTimer);
+        //Time spent without frames is never simulated
+        frameClock.start();
+        rateClock.start();
+        tickDebt = 0;
+        ticksThisSecond = 0;
+    }
+    else if(!animate && paintTimer != 0){
+        killTimer(paintTimer);
+        paintTimer = 0;
+    }
+}
 
-    spawnList.clear();
+void Game::saveGame(){
+    if(scenario != NULL)
+        return; //Nothing to resume
+    SaveGame::write(SaveGame::defaultPath(), sim);
+}
 
-    spawnList = wave_generator.generateSpawnList(getWave(), navPath[0]);
-    enemyCount = spawnList.size();
+bool Game::loadGame(){
+    SaveGame save(SaveGame::defaultPath());
+    if(!save.isValid())
+        return false;
 
-    spawnTimer = startTimer(2000);
-    startTimers();
+    loadInGame();
+    clearGame();
+    const SAVEGAME::Header* h = save.getHeader();
+    sim.setWave(h->wave);
+    sim.setScore(h->score);
+
+    const SAVEGAME::TowerRecord* t = save.getTowers();
+    for(quint32 i = 0; i < h->towerCount; i++, t++){
+        if(t->type < 0 || t->type >= Tower::getTypeCount())
+            continue;
+        Tower* tower = new Tower(static_cast<Type>(t->type), QRect(t->x, t->y, 0, 0));
+        if(t->targeting >= static_cast<int>(Targeting::FIRST) && t->targeting <= static_cast<int>(Targeting::CLOSEST))
+            tower->setTargeting(static_cast<Targeting>(t->targeting));
+        tower->setReadyTime(sim.getTick() + std::max(0.0f, t->coolDown));
+        addTower(tower);
+    }
+
+    const SAVEGAME::StatsRecord* st = save.getStats();
+    for(quint32 i = 0; i < h->statsCount; i++, st++)
+        if(st->type >= 0 && st->type < Tower::getTypeCount())
+            getUpgrades().setCounts(static_cast<Type>(st->type), st->damageUpgrades, st->rangeUpgrades, st->coolDownUpgrades, st->built);
+
+    std::vector<Enemy*> restored(h->enemyCount, NULL);
+    const SAVEGAME::EnemyRecord* e = save.getEnemies();
+    for(quint32 i = 0; i < h->enemyCount; i++, e++){
+        if(e->type < 0 || e->type >= EnemyTable::size() ||
+           e->waypoint < 0 || e->waypoint > CONSTANTS::PATH_TILE_COUNT-2)
+            continue;
+        Enemy* enemy = new Enemy(e->type, sim.getSpawnPoint());
+        enemy->getRect()->moveTo(e->x, e->y);
+        enemy->setHealth(e->health);
+        enemy->setCurWaypoint(e->waypoint);
+        enemy->setFacingRight(e->faceRight != 0);
+        enemy->setStride(std::max(0.0f, std::min(1.0f, e->stride)));
+        sim.addEnemy(enemy);
+        restored[i] = enemy;
+    }
+
+    const SAVEGAME::EffectRecord* f = save.getEffects();
+    for(quint32 i = 0; i < h->effectCount; i++, f++)
+        if(f->effect >= 0 && f->effect < EFFECT_COUNT && f->enemy >= 0 && quint32(f->enemy) < h->enemyCount &&
+           restored[f->enemy] != NULL && f->ticksLeft > 0)
+            sim.getEffects().apply(static_cast<Effect>(f->effect), restored[f->enemy], f->magnitude, sim.getTick() + f->ticksLeft);
+
+    std::vector<SpawnGroup> groups;
+    const SAVEGAME::SpawnRecord* sp = save.getSpawnList();
+    for(quint32 i = 0; i < h->spawnCount; i++, sp++)
+        if(sp->type >= 0 && sp->type < EnemyTable::size() && sp->count > 0)
+            groups.push_back(SpawnGroup(sp->type, sp->count, sp->spacing));
+    sim.queueSpawns(groups, std::max(0, h->spawnDelayMs));
+    setState(INGAME);
+    return true;
 }
 
 void Game::clearGame(){
-    Tower::resetUpgrades();
-
-    for(auto& e : enemies)
-        delete e;
-    enemies.clear();
-    for(auto& t : towers)
-        delete t;
-    towers.clear();
-    for(auto& t : map){
-        t->setOccupied(false);
-    }
-    spawnList.clear();
+    for(size_t i = 0; i < sim.getTowers().size(); i++)
+        hitGrids[INGAME].remove(HIT_TOWER + i);
+    sim.clear();
+    selectedTile = -1;
+    for(auto& d : damageDisplays)
+        delete d;
+    damageDisplays.clear();
+    damageExpiry.clear();
 }
 
 void Game::loadMenu(){
-    title_line1 = mergeChars("tower",0.125,NORMAL);
-    title_line2 = mergeChars("defense",0.125,NORMAL);
-    start_button = new Button(mergeChars("start",0.25,NORMAL), mergeChars("start",0.25,ACTIVE));
-    help_button = new Button(mergeChars("help",0.25,NORMAL), mergeChars("help",0.25,ACTIVE));
-    quit_button = new Button(mergeChars("quit",0.25,NORMAL), mergeChars("quit",0.25,ACTIVE));
-
-    int const top_margin = (height() - (title_line1->getRect()->height() + title_line2->getRect()->height() +
-                           start_button->getRect()->height() + help_button->getRect()->height() +
-                           quit_button->getRect()->height()))/2;
-
-    title_line1->getRect()->moveTo( (width()-title_line1->getRect()->width())/2 , top_margin );
-    title_line2->getRect()->moveTo( (width()-title_line2->getRect()->width())/2 , top_margin + title_line1->getRect()->height());
-    start_button->getRect()->moveTo( (width()-start_button->getRect()->width())/2 , top_margin + title_line1->getRect()->height() + title_line2->getRect()->height());
-    help_button->getRect()->moveTo( (width()-help_button->getRect()->width())/2 , top_margin + title_line1->getRect()->height() + title_line2->getRect()->height() + start_button->getRect()->height());
-    quit_button->getRect()->moveTo( (width()-quit_button->getRect()->width())/2 , top_margin + title_line1->getRect()->height() + title_line2->getRect()->height() + start_button->getRect()->height() + help_button->getRect()->height());
+    title_line1 = mergeChars("tower",ASSETS::TITLE_SCALE,NORMAL);
+    title_line2 = mergeChars("defense",ASSETS::TITLE_SCALE,NORMAL);
+    start_button = new Button(mergeChars("start",ASSETS::BUTTON_SCALE,NORMAL), mergeChars("start",ASSETS::BUTTON_SCALE,ACTIVE));
+    load_button = new Button(mergeChars("load",ASSETS::BUTTON_SCALE,NORMAL), mergeChars("load",ASSETS::BUTTON_SCALE,ACTIVE));
+    help_button = new Button(mergeChars("help",ASSETS::BUTTON_SCALE,NORMAL), mergeChars("help",ASSETS::BUTTON_SCALE,ACTIVE));
+    stress_button = new Button(mergeChars("stress",ASSETS::BUTTON_SCALE,NORMAL), mergeChars("stress",ASSETS::BUTTON_SCALE,ACTIVE));
+    quit_button = new Button(mergeChars("quit",ASSETS::BUTTON_SCALE,NORMAL), mergeChars("quit",ASSETS::BUTTON_SCALE,ACTIVE));
+
+    int const top_margin = (CONSTANTS::SCREEN_HEIGHT - (title_line1->getRect()->height() + title_line2->getRect()->height() +
+                           start_button->getRect()->height() + load_button->getRect()->height() +
+                           help_button->getRect()->height() + stress_button->getRect()->height() + quit_button->getRect()->height()))/2;
+
+    title_line1->getRect()->moveTo( (CONSTANTS::SCREEN_WIDTH-title_line1->getRect()->width())/2 , top_margin );
+    title_line2->getRect()->moveTo( (CONSTANTS::SCREEN_WIDTH-title_line2->getRect()->width())/2 , top_margin + title_line1->getRect()->height());
+    start_button->getRect()->moveTo( (CONSTANTS::SCREEN_WIDTH-start_button->getRect()->width())/2 , top_margin + title_line1->getRect()->height() + title_line2->getRect()->height());
+    load_button->getRect()->moveTo( (CONSTANTS::SCREEN_WIDTH-load_button->getRect()->width())/2 , top_margin + title_line1->getRect()->height() + title_line2->getRect()->height() + start_button->getRect()->height());
+    help_button->getRect()->moveTo( (CONSTANTS::SCREEN_WIDTH-help_button->getRect()->width())/2 , top_margin + title_line1->getRect()->height() + title_line2->getRect()->height() + start_button->getRect()->height() + load_button->getRect()->height());
+    stress_button->getRect()->moveTo( (CONSTANTS::SCREEN_WIDTH-stress_button->getRect()->width())/2 , top_margin + title_line1->getRect()->height() + title_line2->getRect()->height() + start_button->getRect()->height() + load_button->getRect()->height() + help_button->getRect()->height());
+    quit_button->getRect()->moveTo( (CONSTANTS::SCREEN_WIDTH-quit_button->getRect()->width())/2 , top_margin + title_line1->getRect()->height() + title_line2->getRect()->height() + start_button->getRect()->height() + load_button->getRect()->height() + help_button->getRect()->height() + stress_button->getRect()->height());
+
+    hitGrids[MENU].add(HIT_START, start_button->getRectV());
+    hitGrids[MENU].add(HIT_LOAD, load_button->getRectV());
+    hitGrids[MENU].add(HIT_HELP, help_button->getRectV());
+    hitGrids[MENU].add(HIT_STRESS, stress_button->getRectV());
+    hitGrids[MENU].add(HIT_QUIT, quit_button->getRectV());
 }
 
 void Game::cleanMenu(){
     delete title_line1;
     delete title_line2;
     delete start_button;
+    delete load_button;
     delete help_button;
+    delete stress_button;
     delete quit_button;
 }
 
 void Game::loadInGame(){
+    if(inGameLoaded)
+        return;
+    inGameLoaded = true;
+
+    Simulation::loadTables();
+
     score_title = mergeChars("score",1,NORMAL);
     wave_title = mergeChars("wave",1,NORMAL);
     tileHighlight = new Image(CONSTANTS::HIGHLIGHT_TILE);
-    towerOptions.push_back(new Image(CONSTANTS::TOWER_FIRE));
-    towerOptions.push_back(new Image(CONSTANTS::TOWER_ICE));
-    towerOptions.push_back(new Image(CONSTANTS::TOWER_EARTH));
-    towerOptHighlight = new Image(CONSTANTS::TOWEROPT_H);
-
-    for(int i = 0; i<3; i++){
-        fire_upgrade.push_back(new Image(CONSTANTS::UPGRADE_FIRE_BASE));
-        ice_upgrade.push_back(new Image(CONSTANTS::UPGRADE_ICE_BASE));
-        earth_upgrade.push_back(new Image(CONSTANTS::UPGRADE_EARTH_BASE));
+    for(int t = 0; t < Tower::getTypeCount(); t++){
+        towerOptions.push_back(new Image(TowerTable::get(t).sprite));
+        upgrade_base.push_back(new Image(TowerTable::get(t).upgradeIcon));
     }
+    towerOptHighlight = new Image(CONSTANTS::TOWEROPT_H);
     upgrade_icon.push_back(new Image(CONSTANTS::UPGRADE_STRENGTH));
     upgrade_icon.push_back(new Image(CONSTANTS::UPGRADE_RANGE));
     upgrade_icon.push_back(new Image(CONSTANTS::UPGRADE_RATE));
 
-    continue_button = new Button(mergeChars("continue",0.25,NORMAL), mergeChars("continue",0.25,ACTIVE));
+    continue_button = new Button(mergeChars("continue",ASSETS::BUTTON_SCALE,NORMAL), mergeChars("continue",ASSETS::BUTTON_SCALE,ACTIVE));
 
     wave_title->getRect()->moveTo(10,10);
-    score_title->getRect()->moveTo(width()-score_title->getRect()->width()-5, 10);
-    towerOptions[0]->getRect()->moveTo(width()-towerOptions[0]->getRect()->width()-5, 50);
-    towerOptions[1]->getRect()->moveTo(width()-towerOptions[1]->getRect()->width()-5, 50 + towerOptions[0]->getRect()->height());
-    towerOptions[2]->getRect()->moveTo(width()-towerOptions[2]->getRect()->width()-5, 50 + towerOptions[0]->getRect()->height() + towerOptions[1]->getRect()->height());
-
-    int x = width()-towerOptions[0]->getRect()->width()-5;
-    int y = 75 + towerOptions[0]->getRect()->height() + towerOptions[1]->getRect()->height() + towerOptions[2]->getRect()->height();
-    for(size_t i = 0, s = fire_upgrade.size(); i < s; i++){
-        fire_upgrade[i]->getRect()->moveTo(x+(fire_upgrade[i]->getRect()->width())/4, y);
-        ice_upgrade[i]->getRect()->moveTo(x+(fire_upgrade[i]->getRect()->width())/4, y);
-        earth_upgrade[i]->getRect()->moveTo(x+(fire_upgrade[i]->getRect()->width())/4, y);
-        upgrade_icon[i]->getRect()->moveTo(x+(fire_upgrade[i]->getRect()->width())/4, y);
-        y+= fire_upgrade[i]->getRect()->height()+2;
+    score_title->getRect()->moveTo(CONSTANTS::SCREEN_WIDTH-score_title->getRect()->width()-5, 10);
+    int y = 50;
+    for(auto& o : towerOptions){
+        o->getRect()->moveTo(CONSTANTS::SCREEN_WIDTH-o->getRect()->width()-5, y);
+        y += o->getRect()->height();
+    }
+
+    int x = CONSTANTS::SCREEN_WIDTH-towerOptions[0]->getRect()->width()-5;
+    y += 25;
+    for(auto& i : upgrade_icon){
+        i->getRect()->moveTo(x+(upgrade_base[0]->getRect()->width())/4, y);
+        y+= upgrade_base[0]->getRect()->height()+2;
     }
 
-    continue_button->getRect()->moveTo( (width()-continue_button->getRect()->width())/2 , 264);
+    continue_button->getRect()->moveTo( (CONSTANTS::SCREEN_WIDTH-continue_button->getRect()->width())/2 , 264);
+
+    for(size_t i = 0; i < towerOptions.size(); i++)
+        hitGrids[INGAME].add(HIT_TOWER_OPTION + i, towerOptions[i]->getRectV());
+    hitGrids[INGAME].add(HIT_UPGRADE_DAMAGE, upgrade_icon[0]->getRectV());
+    hitGrids[INGAME].add(HIT_UPGRADE_RANGE, upgrade_icon[1]->getRectV());
+    hitGrids[INGAME].add(HIT_UPGRADE_RATE, upgrade_icon[2]->getRectV());
+    hitGrids[CLEARED].add(HIT_CONTINUE, continue_button->getRectV());
 
     buildMap();
-    createNavigationPath();
 }
 
 void Game::fillCharReferences(){
-    letterChars.push_back(new Image(CHARS::CHAR_0));
-    letterChars.push_back(new Image(CHARS::CHAR_1));
-    letterChars.push_back(new Image(CHARS::CHAR_2));
-    letterChars.push_back(new Image(CHARS::CHAR_3));
-    letterChars.push_back(new Image(CHARS::CHAR_4));
-    letterChars.push_back(new Image(CHARS::CHAR_5));
-    letterChars.push_back(new Image(CHARS::CHAR_6));
-    letterChars.push_back(new Image(CHARS::CHAR_7));
-    letterChars.push_back(new Image(CHARS::CHAR_8));
-    letterChars.push_back(new Image(CHARS::CHAR_9));
-    letterChars.push_back(new Image(CHARS::CHAR_A));
-    letterChars.push_back(new Image(CHARS::CHAR_B));
-    letterChars.push_back(new Image(CHARS::CHAR_C));
-    letterChars.push_back(new Image(CHARS::CHAR_D));
-    letterChars.push_back(new Image(CHARS::CHAR_E));
-    letterChars.push_back(new Image(CHARS::CHAR_F));
-    letterChars.push_back(new Image(CHARS::CHAR_G));
-    letterChars.push_back(new Image(CHARS::CHAR_H));
-    letterChars.push_back(new Image(CHARS::CHAR_I));
-    letterChars.push_back(new Image(CHARS::CHAR_J));
-    letterChars.push_back(new Image(CHARS::CHAR_K));
-    letterChars.push_back(new Image(CHARS::CHAR_L));
-    letterChars.push_back(new Image(CHARS::CHAR_M));
-    letterChars.push_back(new Image(CHARS::CHAR_N));
-    letterChars.push_back(new Image(CHARS::CHAR_O));
-    letterChars.push_back(new Image(CHARS::CHAR_P));
-    letterChars.push_back(new Image(CHARS::CHAR_Q));
-    letterChars.push_back(new Image(CHARS::CHAR_R));
-    letterChars.push_back(new Image(CHARS::CHAR_S));
-    letterChars.push_back(new Image(CHARS::CHAR_T));
-    letterChars.push_back(new Image(CHARS::CHAR_U));
-    letterChars.push_back(new Image(CHARS::CHAR_V));
-    letterChars.push_back(new Image(CHARS::CHAR_W));
-    letterChars.push_back(new Image(CHARS::CHAR_X));
-    letterChars.push_back(new Image(CHARS::CHAR_Y));
-    letterChars.push_back(new Image(CHARS::CHAR_Z));
-
-    letterCharsAct.push_back(new Image(CHARS::CHAR_0_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_1_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_2_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_3_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_4_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_5_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_6_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_7_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_8_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_9_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_A_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_B_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_C_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_D_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_E_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_F_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_G_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_H_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_I_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_J_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_K_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_L_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_M_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_N_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_O_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_P_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_Q_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_R_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_S_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_T_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_U_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_V_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_W_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_X_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_Y_ACT));
-    letterCharsAct.push_back(new Image(CHARS::CHAR_Z_ACT));
-
-    letterCharsRed.push_back(new Image(CHARS::CHAR_0_RED));
-    letterCharsRed.push_back(new Image(CHARS::CHAR_1_RED));
-    letterCharsRed.push_back(new Image(CHARS::CHAR_2_RED));
-    letterCharsRed.push_back(new Image(CHARS::CHAR_3_RED));
-    letterCharsRed.push_back(new Image(CHARS::CHAR_4_RED));
-    letterCharsRed.push_back(new Image(CHARS::CHAR_5_RED));
-    letterCharsRed.push_back(new Image(CHARS::CHAR_6_RED));
-    letterCharsRed.push_back(new Image(CHARS::CHAR_7_RED));
-    letterCharsRed.push_back(new Image(CHARS::CHAR_8_RED));
-    letterCharsRed.push_back(new Image(CHARS::CHAR_9_RED));
-
-    specialChars.push_back(new Image(CHARS::CHAR_SPACE));
+    for(const auto& c : NORMAL_CHARS)
+        letterChars.push_back(new Image(c));
+    for(const auto& c : ACTIVE_CHARS)
+        letterCharsAct.push_back(new Image(c));
+    for(const auto& c : RED_CHARS)
+        letterCharsRed.push_back(new Image(c));
+    for(const auto& c : SPECIAL_CHARS)
+        specialChars.push_back(new Image(c));
 }
 
 void Game::cleanInGame(){
+    if(!inGameLoaded)
+        return;
     delete score_title;
     delete wave_title;
     delete tileHighlight;
+    delete towerOptHighlight;
+    delete continue_button;
     delete tooltip;
     for(auto& t : map)
         delete t;
     for(auto& o : towerOptions)
         delete o;
+    for(auto& u : upgrade_base)
+        delete u;
+    for(auto& u : upgrade_icon)
+        delete u;
     for(auto& d : damageDisplays)
         delete d;
-    for(auto& e : enemies)
-        delete e;
 }
 
 void Game::loadPause(){
-    pauseButtons.push_back(new Button(mergeChars("resume",0.25,NORMAL), mergeChars("resume",0.25,ACTIVE)));
-    pauseButtons.push_back(new Button(mergeChars("main menu",0.25,NORMAL), mergeChars("main menu",0.25,ACTIVE)));
-
-    int const top_margin = (height() - (pauseButtons[0]->getRect()->height() + pauseButtons[1]->getRect()->height()))/2;
-    pauseButtons[0]->getRect()->moveTo( (width()-pauseButtons[0]->getRect()->width())/2 , top_margin);
-    pauseButtons[1]->getRect()->moveTo( (width()-pauseButtons[1]->getRect()->width())/2 , top_margin+pauseButtons[0]->getRect()->height());
+    if(pauseLoaded)
+        return;
+    pauseLoaded = true;
+    pauseButtons.push_back(new Button(mergeChars("resume",ASSETS::BUTTON_SCALE,NORMAL), mergeChars("resume",ASSETS::BUTTON_SCALE,ACTIVE)));
+    pauseButtons.push_back(new Button(mergeChars("main menu",ASSETS::BUTTON_SCALE,NORMAL), mergeChars("main menu",ASSETS::BUTTON_SCALE,ACTIVE)));
+
+    int const top_margin = (CONSTANTS::SCREEN_HEIGHT - (pauseButtons[0]->getRect()->height() + pauseButtons[1]->getRect()->height()))/2;
+    pauseButtons[0]->getRect()->moveTo( (CONSTANTS::SCREEN_WIDTH-pauseButtons[0]->getRect()->width())/2 , top_margin);
+    pauseButtons[1]->getRect()->moveTo( (CONSTANTS::SCREEN_WIDTH-pauseButtons[1]->getRect()->width())/2 , top_margin+pauseButtons[0]->getRect()->height());
+
+    hitGrids[PAUSED].add(HIT_RESUME, pauseButtons[0]->getRectV());
+    hitGrids[PAUSED].add(HIT_MAIN_MENU, pauseButtons[1]->getRectV());
 }
 
 void Game::cleanPause(){
@@ -640,18 +888,25 @@ void Game::cleanPause(){
 }
 
 void Game::loadHelp(){
-    arrows.push_back(new Button(CONSTANTS::LEFT_PATH, CONSTANTS::LEFT_H_PATH, 0.25));
-    arrows.push_back(new Button(CONSTANTS::RIGHT_PATH, CONSTANTS::RIGHT_H_PATH, 0.25));
-    arrows.push_back(new Button(mergeChars("back",0.5,NORMAL), mergeChars("back",0.5,ACTIVE)));
+    if(helpLoaded)
+        return;
+    helpLoaded = true;
+    arrows.push_back(new Button(CONSTANTS::LEFT_PATH, CONSTANTS::LEFT_H_PATH, ASSETS::BUTTON_SCALE));
+    arrows.push_back(new Button(CONSTANTS::RIGHT_PATH, CONSTANTS::RIGHT_H_PATH, ASSETS::BUTTON_SCALE));
+    arrows.push_back(new Button(mergeChars("back",ASSETS::BACK_SCALE,NORMAL), mergeChars("back",ASSETS::BACK_SCALE,ACTIVE)));
     helpImages.push_back(new Image(CONSTANTS::HELP_SELECT_TOWER));
     helpImages.push_back(new Image(CONSTANTS::HELP_UPGRADE));
     helpImages.push_back(new Image(CONSTANTS::HELP_BUILD_TOWER));
 
     arrows[2]->getRect()->moveTo( 10, 10);
-    arrows[0]->getRect()->moveTo( 30, (height()-arrows[0]->getRect()->height())/2);
-    arrows[1]->getRect()->moveTo( width()-30-arrows[1]->getRect()->width(), (height()-arrows[1]->getRect()->height())/2);
+    arrows[0]->getRect()->moveTo( 30, (CONSTANTS::SCREEN_HEIGHT-arrows[0]->getRect()->height())/2);
+    arrows[1]->getRect()->moveTo( CONSTANTS::SCREEN_WIDTH-30-arrows[1]->getRect()->width(), (CONSTANTS::SCREEN_HEIGHT-arrows[1]->getRect()->height())/2);
     for(auto& i : helpImages)
-        i->getRect()->moveTo((width()-i->getRect()->width())/2, (height()-i->getRect()->height())/2);
+        i->getRect()->moveTo((CONSTANTS::SCREEN_WIDTH-i->getRect()->width())/2, (CONSTANTS::SCREEN_HEIGHT-i->getRect()->height())/2);
+
+    hitGrids[HELP].add(HIT_PREV, arrows[0]->getRectV());
+    hitGrids[HELP].add(HIT_NEXT, arrows[1]->getRectV());
+    hitGrids[HELP].add(HIT_BACK, arrows[2]->getRectV());
 }
 
 void Game::cleanHelp(){
@@ -664,92 +919,41 @@ void Game::cleanHelp(){
 void Game::buildMap(){
     for(const auto d : CONSTANTS::MAP)
         d==0 ?  map.push_back(new Tile(CONSTANTS::GRASS_TILE)) : map.push_back(new Tile(CONSTANTS::DIRT_TILE,d));
-    int xPos = 50;
-    int yPos = 50;
-    int colCounter = 0;
-    for(auto& t : map){
-        t->getRect()->moveTo(xPos, yPos);
-        if(++colCounter<CONSTANTS::TILE_COL)
-            xPos += t->getRect()->width();
-        else{
-            xPos = 50;
-            colCounter = 0;
-            yPos += t->getRect()->height();
-        }
-    }
+    for(size_t i = 0; i < map.size(); i++)
+        map[i]->getRect()->moveTo(sim.getTiles().rectOf(i).topLeft());
 }
 
-void Game::selectTile(Tile* t){
-    if(!t->isActive()){
-        t->setActive(true);
-        tileHighlight->getRect()->moveTo(t->getRect()->topLeft());
+//The first click on a free tile highlights it, a second one builds there. Anything else drops the highlight.
+void Game::selectTile(int tile){
+    if(tile < 0 || !sim.getTiles().canBuild(tile))
+        selectedTile = -1;
+    else if(selectedTile != tile){
+        selectedTile = tile;
+        tileHighlight->getRect()->moveTo(sim.getTiles().rectOf(tile).topLeft());
     }
     else{
-        t->setActive(false);
-        switch(curTowerOpt){
-            case 0:
-                if(getScore() >= Tower::getCost(curTowerType)){
-                    updateScore(-Tower::getCost(curTowerType));
-                    towers.push_back(new Tower(CONSTANTS::TOWER_FIRE, *t->getRect()));
-                    t->setOccupied(true);
-                }
-                break;
-            case 1:
-                if(getScore() >= Tower::getCost(curTowerType)){
-                    updateScore(-Tower::getCost(curTowerType));
-                    towers.push_back(new Tower(CONSTANTS::TOWER_ICE, *t->getRect()));
-                    t->setOccupied(true);
-                }
-                break;
-            case 2:
-                if(getScore() >= Tower::getCost(curTowerType)){
-                    updateScore(-Tower::getCost(curTowerType));
-                    towers.push_back(new Tower(CONSTANTS::TOWER_EARTH, *t->getRect()));
-                    t->setOccupied(true);
-                }
-                break;
-        }
-    }
-}
-
-void Game::raycast(){
-    for(auto& t : towers){
-        for(auto& e : enemies){
-            int distance = QLineF(t->getRect()->center(), e->getRect()->center()).length();
-            if(distance < t->getRange(t->getType()) && !t->isCoolDown()){
-                t->setCoolDown(true);
-                QTimer::singleShot(t->getCoolDown(t->getType()),t,SLOT(toggleCoolDown()));
-                e->inflictDamage(t->getDamage(t->getType()));
-                Image* damage = mergeChars(std::to_string(t->getDamage(t->getType())),1,RED);
-                damage->getRect()->moveTo(e->getRect()->center().x()+damageDisplayOffset(generator), e->getRect()->top());
-                damageDisplays.push_back(damage);
-                QTimer::singleShot(1000,this,SLOT(removeDecal()));
-
-                if(e->getHealth() <= 0){
-                    e->setDead(true);
-                    enemyCount--;
-                    cleanEnemyList();
-                    //End wave
-                    if(enemyCount == 0)
-                        state = CLEARED;
-                }
-                break;
-            }
+        selectedTile = -1;
+        if(getScore() >= getUpgrades().getCost(curTowerType)){
+            updateScore(-getUpgrades().getCost(curTowerType));
+            getUpgrades().countBuilt(curTowerType);
+            addTower(new Tower(curTowerType, sim.getTiles().rectOf(tile)));
         }
     }
 }
 
-void Game::cleanEnemyList(){
-    for(size_t i = 0; i<enemies.size(); i++){
-        if(enemies[i]->isDead()){
-            updateScore(enemies[i]->getScore());
-            delete enemies[i];
-            enemies.erase(enemies.begin()+i);
-        }
-    }
+void Game::addTower(Tower* t){
+    hitGrids[INGAME].add(HIT_TOWER + sim.getTowers().size(), t->getRectV());
+    sim.addTower(t);
 }
 
+//Every merged string is kept, so damage numbers and tooltips with the same text share one image and
+//the viewport finds it in the atlas instead of scaling a new one for each hit
 Image* Game::mergeChars(std::string word, double scale, Chars c){
+    MergedKey key(word, scale, c);
+    auto cached = mergedChars.find(key);
+    if(cached != mergedChars.end())
+        return new Image(*cached->second);
+
     Image* image = new Image();
 
     for(size_t i = 0; i < word.length(); i++){
@@ -1019,251 +1223,251 @@ Image* Game::mergeChars(std::string word, double scale, Chars c){
         }
     }
 
+    mergedChars[key] = new Image(*image);
     return image;
 }
 
 void Game::appendChar(Image* character, double scale, Image* i){
     Image* copy = character->scaledCopy(scale);
     i->append(copy);
+    delete copy;
 }
 
-void Game::printChar(Image* character, double scale, QPainter& p, int& x, int& y){
-    Image* copy = character->scaledCopy(scale);
-    copy->getRect()->moveTo(x,y);
-    p.drawImage(*copy->getRect(),*copy->getImage());
-    x += copy->getRect()->width();
-    delete copy;
+void Game::printChar(Image* character, double scale, int& x, int& y){
+    QRect glyph(x, y, character->getRect()->width()/scale, character->getRect()->height()/scale);
+    viewport.draw(LAYER_HUD, glyph, *character->getImage());
+    x += glyph.width();
 }
 
-void Game::paintChar(std::string word, double scale, QPainter& p, int x, int y, bool active){
+void Game::paintChar(std::string word, double scale, int x, int y, bool active){
     for(size_t i = 0; i < word.length(); i++){
         if(active){
             switch(word[i]){
             case '0':
-                printChar(letterCharsAct[0], scale, p, x, y);
+                printChar(letterCharsAct[0], scale, x, y);
                 break;
             case '1':
-                printChar(letterCharsAct[1], scale, p, x, y);
+                printChar(letterCharsAct[1], scale, x, y);
                 break;
             case '2':
-                printChar(letterCharsAct[2], scale, p, x, y);
+                printChar(letterCharsAct[2], scale, x, y);
                 break;
             case '3':
-                printChar(letterCharsAct[3], scale, p, x, y);
+                printChar(letterCharsAct[3], scale, x, y);
                 break;
             case '4':
-                printChar(letterCharsAct[4], scale, p, x, y);
+                printChar(letterCharsAct[4], scale, x, y);
                 break;
             case '5':
-                printChar(letterCharsAct[5], scale, p, x, y);
+                printChar(letterCharsAct[5], scale, x, y);
                 break;
             case '6':
-                printChar(letterCharsAct[6], scale, p, x, y);
+                printChar(letterCharsAct[6], scale, x, y);
                 break;
             case '7':
-                printChar(letterCharsAct[7], scale, p, x, y);
+                printChar(letterCharsAct[7], scale, x, y);
                 break;
             case '8':
-                printChar(letterCharsAct[8], scale, p, x, y);
+                printChar(letterCharsAct[8], scale, x, y);
                 break;
             case '9':
-                printChar(letterCharsAct[9], scale, p, x, y);
+                printChar(letterCharsAct[9], scale, x, y);
                 break;
             case 'a':
-                printChar(letterCharsAct[10], scale, p, x, y);
+                printChar(letterCharsAct[10], scale, x, y);
                 break;
             case 'b':
-                printChar(letterCharsAct[11], scale, p, x, y);
+                printChar(letterCharsAct[11], scale, x, y);
                 break;
             case 'c':
-                printChar(letterCharsAct[12], scale, p, x, y);
+                printChar(letterCharsAct[12], scale, x, y);
                 break;
             case 'd':
-                printChar(letterCharsAct[13], scale, p, x, y);
+                printChar(letterCharsAct[13], scale, x, y);
                 break;
             case 'e':
-                printChar(letterCharsAct[14], scale, p, x, y);
+                printChar(letterCharsAct[14], scale, x, y);
                 break;
             case 'f':
-                printChar(letterCharsAct[15], scale, p, x, y);
+                printChar(letterCharsAct[15], scale, x, y);
                 break;
             case 'g':
-                printChar(letterCharsAct[16], scale, p, x, y);
+                printChar(letterCharsAct[16], scale, x, y);
                 break;
             case 'h':
-                printChar(letterCharsAct[17], scale, p, x, y);
+                printChar(letterCharsAct[17], scale, x, y);
                 break;
             case 'i':
-                printChar(letterCharsAct[18], scale, p, x, y);
+                printChar(letterCharsAct[18], scale, x, y);
                 break;
             case 'j':
-                printChar(letterCharsAct[19], scale, p, x, y);
+                printChar(letterCharsAct[19], scale, x, y);
                 break;
             case 'k':
-                printChar(letterCharsAct[20], scale, p, x, y);
+                printChar(letterCharsAct[20], scale, x, y);
                 break;
             case 'l':
-                printChar(letterCharsAct[21], scale, p, x, y);
+                printChar(letterCharsAct[21], scale, x, y);
                 break;
             case 'm':
-                printChar(letterCharsAct[22], scale, p, x, y);
+                printChar(letterCharsAct[22], scale, x, y);
                 break;
             case 'n':
-                printChar(letterCharsAct[23], scale, p, x, y);
+                printChar(letterCharsAct[23], scale, x, y);
                 break;
             case 'o':
-                printChar(letterCharsAct[24], scale, p, x, y);
+                printChar(letterCharsAct[24], scale, x, y);
                 break;
             case 'p':
-                printChar(letterCharsAct[25], scale, p, x, y);
+                printChar(letterCharsAct[25], scale, x, y);
                 break;
             case 'q':
-                printChar(letterCharsAct[26], scale, p, x, y);
+                printChar(letterCharsAct[26], scale, x, y);
                 break;
             case 'r':
-                printChar(letterCharsAct[27], scale, p, x, y);
+                printChar(letterCharsAct[27], scale, x, y);
                 break;
             case 's':
-                printChar(letterCharsAct[28], scale, p, x, y);
+                printChar(letterCharsAct[28], scale, x, y);
                 break;
             case 't':
-                printChar(letterCharsAct[29], scale, p, x, y);
+                printChar(letterCharsAct[29], scale, x, y);
                 break;
             case 'u':
-                printChar(letterCharsAct[30], scale, p, x, y);
+                printChar(letterCharsAct[30], scale, x, y);
                 break;
             case 'v':
-                printChar(letterCharsAct[31], scale, p, x, y);
+                printChar(letterCharsAct[31], scale, x, y);
                 break;
             case 'w':
-                printChar(letterCharsAct[32], scale, p, x, y);
+                printChar(letterCharsAct[32], scale, x, y);
                 break;
             case 'x':
-                printChar(letterCharsAct[33], scale, p, x, y);
+                printChar(letterCharsAct[33], scale, x, y);
                 break;
             case 'y':
-                printChar(letterCharsAct[34], scale, p, x, y);
+                printChar(letterCharsAct[34], scale, x, y);
                 break;
             case 'z':
-                printChar(letterCharsAct[35], scale, p, x, y);
+                printChar(letterCharsAct[35], scale, x, y);
                 break;
             case ' ':
-                printChar(specialChars[0], scale, p, x, y);
+                printChar(specialChars[0], scale, x, y);
                 break;
         }
         }
         else{
             switch(word[i]){
                 case '0':
-                    printChar(letterChars[0], scale, p, x, y);
+                    printChar(letterChars[0], scale, x, y);
                     break;
                 case '1':
-                    printChar(letterChars[1], scale, p, x, y);
+                    printChar(letterChars[1], scale, x, y);
                     break;
                 case '2':
-                    printChar(letterChars[2], scale, p, x, y);
+                    printChar(letterChars[2], scale, x, y);
                     break;
                 case '3':
-                    printChar(letterChars[3], scale, p, x, y);
+                    printChar(letterChars[3], scale, x, y);
                     break;
                 case '4':
-                    printChar(letterChars[4], scale, p, x, y);
+                    printChar(letterChars[4], scale, x, y);
                     break;
                 case '5':
-                    printChar(letterChars[5], scale, p, x, y);
+                    printChar(letterChars[5], scale, x, y);
                     break;
                 case '6':
-                    printChar(letterChars[6], scale, p, x, y);
+                    printChar(letterChars[6], scale, x, y);
                     break;
                 case '7':
-                    printChar(letterChars[7], scale, p, x, y);
+                    printChar(letterChars[7], scale, x, y);
                     break;
                 case '8':
-                    printChar(letterChars[8], scale, p, x, y);
+                    printChar(letterChars[8], scale, x, y);
                     break;
                 case '9':
-                    printChar(letterChars[9], scale, p, x, y);
+                    printChar(letterChars[9], scale, x, y);
                     break;
                 case 'a':
-                    printChar(letterChars[10], scale, p, x, y);
+                    printChar(letterChars[10], scale, x, y);
                     break;
                 case 'b':
-                    printChar(letterChars[11], scale, p, x, y);
+                    printChar(letterChars[11], scale, x, y);
                     break;
                 case 'c':
-                    printChar(letterChars[12], scale, p, x, y);
+                    printChar(letterChars[12], scale, x, y);
                     break;
                 case 'd':
-                    printChar(letterChars[13], scale, p, x, y);
+                    printChar(letterChars[13], scale, x, y);
                     break;
                 case 'e':
-                    printChar(letterChars[14], scale, p, x, y);
+                    printChar(letterChars[14], scale, x, y);
                     break;
                 case 'f':
-                    printChar(letterChars[15], scale, p, x, y);
+                    printChar(letterChars[15], scale, x, y);
                     break;
                 case 'g':
-                    printChar(letterChars[16], scale, p, x, y);
+                    printChar(letterChars[16], scale, x, y);
                     break;
                 case 'h':
-                    printChar(letterChars[17], scale, p, x, y);
+                    printChar(letterChars[17], scale, x, y);
                     break;
                 case 'i':
-                    printChar(letterChars[18], scale, p, x, y);
+                    printChar(letterChars[18], scale, x, y);
                     break;
                 case 'j':
-                    printChar(letterChars[19], scale, p, x, y);
+                    printChar(letterChars[19], scale, x, y);
                     break;
                 case 'k':
-                    printChar(letterChars[20], scale, p, x, y);
+                    printChar(letterChars[20], scale, x, y);
                     break;
                 case 'l':
-                    printChar(letterChars[21], scale, p, x, y);
+                    printChar(letterChars[21], scale, x, y);
                     break;
                 case 'm':
-                    printChar(letterChars[22], scale, p, x, y);
+                    printChar(letterChars[22], scale, x, y);
                     break;
                 case 'n':
-                    printChar(letterChars[23], scale, p, x, y);
+                    printChar(letterChars[23], scale, x, y);
                     break;
                 case 'o':
-                    printChar(letterChars[24], scale, p, x, y);
+                    printChar(letterChars[24], scale, x, y);
                     break;
                 case 'p':
-                    printChar(letterChars[25], scale, p, x, y);
+                    printChar(letterChars[25], scale, x, y);
                     break;
                 case 'q':
-                    printChar(letterChars[26], scale, p, x, y);
+                    printChar(letterChars[26], scale, x, y);
                     break;
                 case 'r':
-                    printChar(letterChars[27], scale, p, x, y);
+                    printChar(letterChars[27], scale, x, y);
                     break;
                 case 's':
-                    printChar(letterChars[28], scale, p, x, y);
+                    printChar(letterChars[28], scale, x, y);
                     break;
                 case 't':
-                    printChar(letterChars[29], scale, p, x, y);
+                    printChar(letterChars[29], scale, x, y);
                     break;
                 case 'u':
-                    printChar(letterChars[30], scale, p, x, y);
+                    printChar(letterChars[30], scale, x, y);
                     break;
                 case 'v':
-                    printChar(letterChars[31], scale, p, x, y);
+                    printChar(letterChars[31], scale, x, y);
                     break;
                 case 'w':
-                    printChar(letterChars[32], scale, p, x, y);
+                    printChar(letterChars[32], scale, x, y);
                     break;
                 case 'x':
-                    printChar(letterChars[33], scale, p, x, y);
+                    printChar(letterChars[33], scale, x, y);
                     break;
                 case 'y':
-                    printChar(letterChars[34], scale, p, x, y);
+                    printChar(letterChars[34], scale, x, y);
                     break;
                 case 'z':
-                    printChar(letterChars[35], scale, p, x, y);
+                    printChar(letterChars[35], scale, x, y);
                     break;
                 case ' ':
-                    printChar(specialChars[0], scale, p, x, y);
+                    printChar(specialChars[0], scale, x, y);
                     break;
             }
         }
@@ -1271,13 +1475,6 @@ void Game::paintChar(std::string word, double scale, QPainter& p, int x, int y,
 
 }
 
-void Game::createNavigationPath(){
-    for(auto& t : map){
-        if(t->isPath())
-            navPath[t->getPathID()-1] = t->getRect()->center();
-    }
-}
-
 Game::ToolTip::ToolTip(Image* s, Image* s_u, Image* c, Image* c_a) : upgrade(true)
 {
     cost = c;
@@ -1285,6 +1482,7 @@ Game::ToolTip::ToolTip(Image* s, Image* s_u, Image* c, Image* c_a) : upgrade(tru
     stat = s;
     stat_upgrade = s_u;
     background = new Image(TOOLTIP::BASE);
+    resizeBackground();
 }
 
 Game::ToolTip::ToolTip(Image* c, Image* c_a) : upgrade(false)
@@ -1292,6 +1490,7 @@ Game::ToolTip::ToolTip(Image* c, Image* c_a) : upgrade(false)
     stat = c;
     stat_upgrade = c_a;
     background = new Image(TOOLTIP::BASE);
+    resizeBackground();
 }
 
 Game::ToolTip::~ToolTip(){
@@ -1307,7 +1506,6 @@ Game::ToolTip::~ToolTip(){
 void Game::ToolTip::moveTo(QPointF position){
     int x = position.x();
     int y = position.y();
-    resizeBackground();
     background->getRect()->moveTo(x-background->getRect()->width(), y);
     stat->getRect()->moveTo(background->getRect()->x()+2, background->getRect()->y()+2);
     stat_upgrade->getRect()->moveTo(stat->getRect()->right()+3, stat->getRect()->y());
@@ -1317,13 +1515,13 @@ void Game::ToolTip::moveTo(QPointF position){
     }
 }
 
-void Game::ToolTip::paint(QPainter *p){
-    p->drawImage(*background->getRect(), *background->getImage());
-    p->drawImage(*stat->getRect(), *stat->getImage());
-    p->drawImage(*stat_upgrade->getRect(), *stat_upgrade->getImage());
+void Game::ToolTip::paint(Viewport& v){
+    v.draw(LAYER_TOOLTIP, *background->getRect(), *background->getImage());
+    v.draw(LAYER_TOOLTIP_TOP, *stat->getRect(), *stat->getImage());
+    v.draw(LAYER_TOOLTIP_TOP, *stat_upgrade->getRect(), *stat_upgrade->getImage());
     if(upgrade){
-        p->drawImage(*cost->getRect(), *cost->getImage());
-        p->drawImage(*cost_amount->getRect(), *cost_amount->getImage());
+        v.draw(LAYER_TOOLTIP_TOP, *cost->getRect(), *cost->getImage());
+        v.draw(LAYER_TOOLTIP_TOP, *cost_amount->getRect(), *cost_amount->getImage());
     }
 }
 
@@ -2,16 +2,23 @@
 #define GAME_H
 
 #include "waypoint.h"
-#include "enemy.h"
 #include "tile.h"
 #include "image.h"
 #include "button.h"
-#include "tower.h"
-#include "wavegenerator.h"
+#include "viewport.h"
+#include "hitgrid.h"
+#include "loadmeter.h"
+#include "scenario.h"
+#include "statehash.h"
+#include "simulation.h"
+#include "framecapture.h"
 #include <QWidget>
+#include <QElapsedTimer>
+#include <QFile>
 #include <deque>
-#include <QTimer>
+#include <map>
 #include <random>
+#include <tuple>
 
 
 namespace TOOLTIP{
@@ -22,6 +29,11 @@ enum State {MENU, INGAME, CLEARED, PAUSED, HELP};
 
 enum Chars {NORMAL, ACTIVE, RED};
 
+//Ids of what can be under the cursor, as registered in each screen's HitGrid. Tower options and placed
+//towers add their index to the base id.
+enum Hit {HIT_NONE = -1, HIT_START, HIT_LOAD, HIT_HELP, HIT_QUIT, HIT_RESUME, HIT_MAIN_MENU, HIT_PREV, HIT_NEXT, HIT_BACK,
+          HIT_CONTINUE, HIT_UPGRADE_DAMAGE, HIT_UPGRADE_RANGE, HIT_UPGRADE_RATE, HIT_STRESS, HIT_TOWER_OPTION = 100, HIT_TOWER = 1000};
+
 class Game : public QWidget
 {
     Q_OBJECT
@@ -29,11 +41,10 @@ class Game : public QWidget
 public:
     Game(QWidget *parent = 0);
     ~Game();
-public slots:
-    void moveDecals(){for(auto& d : damageDisplays)d->getRect()->translate(0,-1); if(state==INGAME)QTimer::singleShot(150,this,SLOT(moveDecals()));}
-    void removeDecal(){Image* front = damageDisplays.front(); damageDisplays.pop_front(); delete front;}
-    void moveEvent(){cleanEnemyList(); moveEnemies(); if(state==INGAME)QTimer::singleShot(30,this,SLOT(moveEvent()));}
-    void collisionEvent(){raycast(); if(state == INGAME)QTimer::singleShot(30,this,SLOT(collisionEvent()));}
+
+    void runScenario(const Scenario& s);
+    bool openHashLog(const QString& filePath);
+    bool openCapture(const QString& dirPath, int intervalMs);
 private:
     void fillCharReferences();
     void loadMenu();
@@ -41,7 +52,6 @@ private:
     void loadPause();
     void loadInGame();
     void buildMap();
-    void createNavigationPath();
 
     void cleanCharReferences();
     void cleanMenu();
@@ -49,58 +59,87 @@ private:
     void cleanPause();
     void cleanInGame();
 
+    bool event(QEvent* event);
     void paintEvent(QPaintEvent* event);
     void timerEvent(QTimerEvent* event);
+    void changeEvent(QEvent* event);
+    void showEvent(QShowEvent* event);
+    void hideEvent(QHideEvent* event);
     void keyPressEvent(QKeyEvent* event);
     void mouseMoveEvent(QMouseEvent *);
     void mousePressEvent(QMouseEvent *);
 
+    void advance();
+    void hover();
+    void tick();
+    void animateEnemies();
+    void moveDecals();
+    void addDecals();
+    void cycleSpeed();
+
     void newGame();
     void clearGame();
-    void selectTile(Tile*);
-    void raycast();
-    void moveEnemies();
-    void cleanEnemyList();
-    void spawner();
-    void newWave();
-    void startTimers();
-
-    inline int getWave() const { return wave_value; }
-    inline int getScore() const { return score_value; }
-
-    inline void updateWave(){ wave_value++; }
-    inline void updateScore(int v) { score_value += v; }
-
-    void paintChar(std::string,double,QPainter&,int,int,bool);
-    void printChar(Image* character, double scale, QPainter& p, int& x, int& y);
+    void saveGame();
+    bool loadGame();
+    void selectTile(int tile);
+    void addTower(Tower* t);
+    void setState(State s);
+    void logStateHash();
+    void finishScenario();
+    void schedule();
+
+    inline int getWave() const { return sim.getWave(); }
+    inline int getScore() const { return sim.getScore(); }
+    inline TowerUpgrades& getUpgrades() { return sim.getUpgrades(); }
+    inline void updateScore(int v) { sim.updateScore(v); }
+
+    void paintChar(std::string,double,int,int,bool);
+    void printChar(Image* character, double scale, int& x, int& y);
     void appendChar(Image* character, double scale, Image* i);
     Image* mergeChars(std::string,double,Chars);
 
-    int wave_value;
-    int score_value;
-    State state;
-    QPointF navPath[CONSTANTS::PATH_TILE_COUNT];
-
-    int paintTimer;
-    int spawnTimer;
+    Button* buttonFor(int hit);
+    void markDirty(const QRect& logical);
 
-    int enemyCount;
-
-   WaveGenerator wave_generator;
+    State state;
+    Simulation sim;
+
+    int paintTimer;  //frame timer, only running while something on screen moves
+    LoadMeter load;
+    Scenario* scenario;  //the stress run in progress, NULL in a normal game
+    QFile* hashLog;      //receives the state hash after every tick, NULL when not asked for
+    quint64 stateHash;
+    FrameCapture* capture;  //saves what is painted every so often while playing, NULL when not asked for
+
+    int speedIndex;
+    double tickDebt;
+    QElapsedTimer frameClock;
+    QElapsedTimer rateClock;
+    int ticksThisSecond;
+    int ticksPerSecond;
+
+    Viewport viewport;
+
+    std::map<State, HitGrid> hitGrids;
+    QPoint mousePos;   //logical position of the last mouse event
+    int hoverTimer;    //pending hover() for the moves since the last one, 0 if none
+    int hovered;
+    QRect hoveredRect;
 
-    std::vector<Enemy*> enemies;
-    std::vector<Enemy*> spawnList;
     std::vector<Tile*> map;
-    std::vector<Tower*> towers;
+    int selectedTile;  //tile showing the build highlight, -1 if none
 
     DEFAULT generator;
     std::uniform_int_distribution<int> damageDisplayOffset;
     std::deque<Image*> damageDisplays;
+    std::deque<qint64> damageExpiry;  //tick each decal in damageDisplays is removed at
 
     Image* title_line1;
     Image* title_line2;
     Button* start_button;
+    Button* load_button;
     Button* help_button;
+    Button* stress_button;
     Button* quit_button;
 
     Image* wave_title;
@@ -111,14 +150,14 @@ private:
     std::vector<Image*> letterCharsAct;
     std::vector<Image*> letterCharsRed;
     std::vector<Image*> specialChars;
+    typedef std::tuple<std::string, double, int> MergedKey;  //text, scale, Chars
+    std::map<MergedKey, Image*> mergedChars;
     std::vector<Image*> towerOptions;
     int curTowerOpt;
     Type curTowerType;
     Image* towerOptHighlight;
-    std::vector<Image*> fire_upgrade;
+    std::vector<Image*> upgrade_base;
     std::vector<Image*> upgrade_icon;
-    std::vector<Image*> ice_upgrade;
-    std::vector<Image*> earth_upgrade;
 
     std::vector<Button*> pauseButtons;
 
@@ -127,10 +166,20 @@ private:
 
     int helpIndex;
 
+    bool helpLoaded;
+    bool pauseLoaded;
+    bool inGameLoaded;
+    QElapsedTimer startupClock;
+    bool firstFrameReported;
+    bool showDebug;    //M toggles the debug overlay: tick rate, draws, load and MemoryStats
+
     class ToolTip;
 
     ToolTip* tooltip;
 
+    ToolTip* tooltipFor(int hit);
+    void showTooltip(ToolTip* t);
+
     class ToolTip{
     public:
         ToolTip(Image* s, Image* s_u, Image*, Image* c_a);
@@ -138,7 +187,8 @@ private:
         ~ToolTip();
 
         void moveTo(QPointF position);
-        void paint(QPainter* p);
+        void paint(Viewport& v);
+        inline QRect getRect() const { return background->getRectV(); }
     private:
         bool upgrade;
         Image* cost;
@@ -1,20 +1,22 @@
 #include "gameobject.h"
+#include "assets.h"
+#include "memorystats.h"
 
 
 GameObject::GameObject(){
-    image = NULL;
-    rect = NULL;
+    MemoryStats::track(MemoryStats::GAME_OBJECTS, 1, 0);
 }
 
-GameObject::GameObject(QString filePath, qreal scale)
+GameObject::GameObject(QString filePath, qreal scale) : image(Assets::image(filePath, scale)), rect(image.rect())
 {
-    QImage* raw = new QImage(filePath);
-    image = new QImage(raw->scaled(raw->width()/scale, raw->height()/scale, Qt::KeepAspectRatio));
-
-    rect = new QRect(image->rect());
+    MemoryStats::track(MemoryStats::GAME_OBJECTS, 1, MemoryStats::bytes(image));
 }
 
 GameObject::~GameObject(){
-    delete image;
-    delete rect;
+    MemoryStats::track(MemoryStats::GAME_OBJECTS, -1, -MemoryStats::bytes(image));
+}
+
+void GameObject::setImage(QImage i){
+    MemoryStats::track(MemoryStats::GAME_OBJECTS, 0, MemoryStats::bytes(i) - MemoryStats::bytes(image));
+    image = i;
 }
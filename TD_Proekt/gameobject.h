@@ -7,8 +7,11 @@
 
 
 namespace CONSTANTS{
+    //Logical playfield size, all layout is in these units and Viewport scales them to the window
     const int SCREEN_WIDTH = 400;
     const int SCREEN_HEIGHT = 400;
+    const int MAP_X = 50;
+    const int MAP_Y = 50;
     const int MARGIN_TOP = 64;
 
     const QString RIGHT_PATH = ":/rightarrow.png";
@@ -23,20 +26,14 @@ namespace CONSTANTS{
     const QString GRASS_TILE = ":/grass_tile.png";
     const QString HIGHLIGHT_TILE = ":/tile_highlight.png";
 
-    const QString TOWER_FIRE = ":/fire.png";
-    const QString TOWER_ICE = ":/ice.png";
-    const QString TOWER_EARTH = ":/rock.png";
-
     const QString TOWEROPT_H = ":/toweroption_h.png";
-    const QString UPGRADE_FIRE_BASE = ":/fire_icon_base.png";
-    const QString UPGRADE_ICE_BASE = ":/ice_icon_base.png";
-    const QString UPGRADE_EARTH_BASE = ":/earth_icon_base.png";
     const QString UPGRADE_STRENGTH = ":/strength_icon.png";
     const QString UPGRADE_RANGE = ":/target_icon.png";
     const QString UPGRADE_RATE = ":/time_icon.png";
 
     const int TILE_ROW = 8;
     const int TILE_COL = 8;
+    const int TILE_SIZE = 32;
     const int PATH_TILE_COUNT = 22;
     const int MAP[TILE_ROW*TILE_COL] = { 0, 0, 0, 0, 0, 0, 1, 0,
                                          0, 7, 6, 5, 4, 3, 2, 0,
@@ -145,16 +142,17 @@ public:
     GameObject(QString, qreal=1);
     virtual ~GameObject();
 
-    inline QRect* getRect(){ return rect; }
-    inline QImage* getImage() { return image; }
-    inline QRect getRectV() const { return *rect; }
-    inline QImage getImageV() const { return *image; }
+    //The image and rect are owned by value, the pointers stay valid for the life of the object
+    inline QRect* getRect(){ return &rect; }
+    inline QImage* getImage() { return &image; }
+    inline QRect getRectV() const { return rect; }
+    inline QImage getImageV() const { return image; }
 
-    inline void setImage(QImage i) { image = new QImage(i); }
-    inline void setRect(QRect r) { rect = new QRect(r); }
+    void setImage(QImage i);
+    inline void setRect(QRect r) { rect = r; }
 private:
-    QImage* image;
-    QRect* rect;
+    QImage image;
+    QRect rect;
 };
 
 #endif // GAMEOBJECT_H
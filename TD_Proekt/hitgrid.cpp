@@ -0,0 +1,56 @@
+#include "hitgrid.h"
+
+#include <algorithm>
+
+using namespace HITGRID;
+
+HitGrid::HitGrid(QSize area) : cols((area.width() + CELL_SIZE - 1)/CELL_SIZE), rows((area.height() + CELL_SIZE - 1)/CELL_SIZE),
+    cells(cols*rows) {}
+
+//Points off the area fall into the edge cells, the rect test still rejects them
+int HitGrid::cellOf(int x, int y) const{
+    int c = std::max(0, std::min(cols-1, x/CELL_SIZE));
+    int r = std::max(0, std::min(rows-1, y/CELL_SIZE));
+    return r*cols + c;
+}
+
+void HitGrid::add(int id, const QRect& r){
+    if(r.isEmpty())
+        return;
+    remove(id);
+    rects[id] = r;
+    int first = cellOf(r.left(), r.top());
+    int last = cellOf(r.right(), r.bottom());
+    for(int y = first/cols; y <= last/cols; y++)
+        for(int x = first%cols; x <= last%cols; x++)
+            cells[y*cols + x].push_back(std::make_pair(id, r));
+}
+
+void HitGrid::remove(int id){
+    auto found = rects.find(id);
+    if(found == rects.end())
+        return;
+    QRect r = found->second;
+    rects.erase(found);
+    int first = cellOf(r.left(), r.top());
+    int last = cellOf(r.right(), r.bottom());
+    for(int y = first/cols; y <= last/cols; y++){
+        for(int x = first%cols; x <= last%cols; x++){
+            auto& cell = cells[y*cols + x];
+            for(size_t i = 0; i < cell.size(); i++){
+                if(cell[i].first == id){
+                    cell.erase(cell.begin() + i);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+int HitGrid::at(QPoint p) const{
+    const auto& cell = cells[cellOf(p.x(), p.y())];
+    for(auto h = cell.rbegin(); h != cell.rend(); ++h)
+        if(h->second.contains(p))
+            return h->first;
+    return -1;
+}
@@ -0,0 +1,37 @@
+#ifndef HITGRID_H
+#define HITGRID_H
+
+#include "gameobject.h"
+#include <QPoint>
+#include <QRect>
+#include <QSize>
+#include <map>
+#include <utility>
+#include <vector>
+
+
+namespace HITGRID{
+    const int CELL_SIZE = 32;
+}
+
+//The interactive rects of one screen, bucketed into cells so a lookup only tests the few rects
+//registered in the cell under the point instead of every element on the screen
+class HitGrid
+{
+public:
+    HitGrid(QSize area = QSize(CONSTANTS::SCREEN_WIDTH, CONSTANTS::SCREEN_HEIGHT));
+
+    void add(int id, const QRect& r);
+    void remove(int id);
+    int at(QPoint p) const;  //id of the last added rect containing p, -1 if none
+
+    inline QRect getRect(int id) const { auto r = rects.find(id); return r == rects.end() ? QRect() : r->second; }
+private:
+    int cols, rows;
+    std::map<int, QRect> rects;
+    std::vector<std::vector<std::pair<int, QRect> > > cells;
+
+    int cellOf(int x, int y) const;
+};
+
+#endif // HITGRID_H
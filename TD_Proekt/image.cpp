@@ -19,17 +19,16 @@ void Image::append(Image *i){
         setRect(getImage()->rect());
     }
     else{
-        QImage* image = new QImage(getImage()->width()+i->getImage()->width(),
-                                 getImage()->height(),
-                                 QImage::Format_ARGB32_Premultiplied);
-        image->fill(qRgba(0,0,0,0));
+        QImage image(getImage()->width()+i->getImage()->width(),
+                     getImage()->height(),
+                     QImage::Format_ARGB32_Premultiplied);
+        image.fill(qRgba(0,0,0,0));
         QPainter painter;
-        painter.begin(image);
+        painter.begin(&image);
         painter.drawImage(0,0,*getImage());
         painter.drawImage(getImage()->width(),0,*i->getImage());
         painter.end();
-        delete getImage();
-        setImage(*image);
-        setRect(image->rect());
+        setImage(image);
+        setRect(image.rect());
     }
 }
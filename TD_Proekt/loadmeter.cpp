@@ -0,0 +1,40 @@
+#include "loadmeter.h"
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+LoadMeter::LoadMeter() : cpuStart(processCpuMs()), wakeups(0), cpuPercent(0), wakeupsPerSecond(0){
+    wall.start();
+}
+
+void LoadMeter::sample(){
+    qint64 elapsed = wall.elapsed();
+    if(elapsed < 1000)
+        return;
+    qint64 cpu = processCpuMs();
+    cpuPercent = (cpu - cpuStart) * 100 / elapsed;
+    wakeupsPerSecond = wakeups * 1000 / elapsed;
+    cpuStart = cpu;
+    wakeups = 0;
+    wall.restart();
+}
+
+//User and kernel time of every thread in the process
+qint64 LoadMeter::processCpuMs(){
+#ifdef Q_OS_WIN
+    FILETIME created, exited, kernel, user;
+    if(!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+        return 0;
+    quint64 k = (quint64(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+    quint64 u = (quint64(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+    return (k + u) / 10000;  //100ns units
+#else
+    rusage r;
+    if(getrusage(RUSAGE_SELF, &r) != 0)
+        return 0;
+    return qint64(r.ru_utime.tv_sec + r.ru_stime.tv_sec)*1000 + (r.ru_utime.tv_usec + r.ru_stime.tv_usec)/1000;
+#endif
+}
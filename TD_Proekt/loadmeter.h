@@ -0,0 +1,30 @@
+#ifndef LOADMETER_H
+#define LOADMETER_H
+
+#include <QElapsedTimer>
+#include <QtGlobal>
+
+
+//Share of one core the process used and how often the event loop woke the game, both over the last
+//whole second. Wakeups are the events delivered to the game widget.
+class LoadMeter
+{
+public:
+    LoadMeter();
+
+    inline void wake() { wakeups++; }
+    void sample();
+
+    inline int getCpuPercent() const { return cpuPercent; }
+    inline int getWakeupsPerSecond() const { return wakeupsPerSecond; }
+private:
+    QElapsedTimer wall;
+    qint64 cpuStart;
+    int wakeups;
+    int cpuPercent;
+    int wakeupsPerSecond;
+
+    static qint64 processCpuMs();
+};
+
+#endif // LOADMETER_H
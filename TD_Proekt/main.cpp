@@ -1,12 +1,60 @@
 #include "game.h"
+#include "assets.h"
+#include "scenario.h"
+#include "statehash.h"
+#include "batchrunner.h"
+#include "simulation.h"
 #include <QApplication>
+#include <QDir>
+#include <QDebug>
 
 int main(int argc, char *argv[])
 {
+    //Build step, see TD_Proekt.pro: writes the preprocessed asset bundle and exits without opening a window
+    if(argc == 3 && QString(argv[1]) == "--pack-assets"){
+        QCoreApplication a(argc, argv);
+        return Assets::pack(QString::fromLocal8Bit(argv[2])) ? 0 : 1;
+    }
+
+    //--batch [games] [waves] [towers] [file] plays headless games on every core and writes their statistics
+    if(argc >= 2 && QString(argv[1]) == BATCH::ARGUMENT){
+        QCoreApplication a(argc, argv);
+        BatchRunner batch;
+        BatchRunner::parse(QCoreApplication::arguments(), batch);
+        Simulation::loadTables();
+        bool written = batch.run();
+        qInfo() << batch.report().c_str();
+        return written ? 0 : 1;
+    }
+
+    //Report the real pixel density so Viewport can render sprites at full resolution on HiDPI screens
+    QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
+    QApplication::setAttribute(Qt::AA_UseHighDpiPixmaps);
     QApplication a(argc, argv);
+    if(!Assets::openBundle(QDir(QCoreApplication::applicationDirPath()).filePath(ASSETS::BUNDLE_FILE)))
+        qInfo() << "no asset bundle, decoding images from resources";
     Game* g;
     g = new Game();
     g->show();
-    return a.exec();
+
+    //--hash-log <file> writes the simulation state hash after every tick, see Game::logStateHash
+    QStringList args = QCoreApplication::arguments();
+    int hashLog = args.indexOf(STATEHASH::ARGUMENT);
+    if(hashLog >= 0 && hashLog+1 < args.size())
+        g->openHashLog(args[hashLog+1]);
+
+    //--capture <dir> [interval ms] saves the playfield as numbered PNGs, see FrameCapture. With -platform offscreen
+    //and --scenario it records a run without a window.
+    int capture = args.indexOf(CAPTURE::ARGUMENT);
+    if(capture >= 0 && capture+1 < args.size())
+        g->openCapture(args[capture+1], capture+2 < args.size() ? args[capture+2].toInt() : CAPTURE::DEFAULT_INTERVAL_MS);
+
+    //Starts the load test straight away and quits when it is done
+    Scenario scenario;
+    if(Scenario::parse(args, scenario))
+        g->runScenario(scenario);
+    int result = a.exec();
+    delete g;
+    return result;
 
 }
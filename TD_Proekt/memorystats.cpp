@@ -0,0 +1,44 @@
+#include "memorystats.h"
+
+std::atomic<int> MemoryStats::live[CATEGORY_COUNT];
+std::atomic<qint64> MemoryStats::held[CATEGORY_COUNT];
+
+const char* MemoryStats::getName(Category c){
+    switch(c){
+        case GAME_OBJECTS:
+            return "objects";
+        case ENEMIES:
+            return "enemies";
+        case ATLAS:
+            return "atlas";
+        case SCALED:
+            return "scaled";
+        case DECODED:
+            return "decoded";
+        case BUNDLE:
+            return "bundle";
+        default:
+            return "";
+    }
+}
+
+//Everything counted but the bundle, which is a read-only file mapping
+qint64 MemoryStats::getHeapBytes(){
+    qint64 total = 0;
+    for(int c = 0; c < CATEGORY_COUNT; c++)
+        if(c != BUNDLE)
+            total += getBytes(static_cast<Category>(c));
+    return total;
+}
+
+//"name live kb" for the categories from first to last, in the characters the HUD font has
+std::string MemoryStats::report(Category first, Category last){
+    std::string out;
+    for(int c = first; c <= last; c++){
+        if(c != first)
+            out += " ";
+        out += std::string(getName(static_cast<Category>(c))) + " " + std::to_string(getLive(static_cast<Category>(c))) + " " +
+               std::to_string(getBytes(static_cast<Category>(c))/1024) + "kb";
+    }
+    return out;
+}
@@ -0,0 +1,31 @@
+#ifndef MEMORYSTATS_H
+#define MEMORYSTATS_H
+
+#include <QImage>
+#include <QtGlobal>
+#include <atomic>
+#include <string>
+
+
+//Live objects and the bytes they hold, per owner. Counters are updated by the owners themselves as they
+//gain and drop images, so the totals can be read at any point to check that nothing grows across waves.
+//The counters are atomic, batch workers create enemies and towers on their own threads.
+class MemoryStats
+{
+public:
+    enum Category {GAME_OBJECTS, ENEMIES, ATLAS, SCALED, DECODED, BUNDLE, CATEGORY_COUNT};
+
+    inline static void track(Category c, int count, qint64 bytes) { live[c] += count; held[c] += bytes; }
+    inline static int getLive(Category c) { return live[c].load(); }
+    inline static qint64 getBytes(Category c) { return held[c].load(); }
+    inline static qint64 bytes(const QImage& i) { return qint64(i.bytesPerLine())*i.height(); }
+
+    static const char* getName(Category c);
+    static qint64 getHeapBytes();
+    static std::string report(Category first, Category last);
+private:
+    static std::atomic<int> live[CATEGORY_COUNT];
+    static std::atomic<qint64> held[CATEGORY_COUNT];
+};
+
+#endif // MEMORYSTATS_H
@@ -0,0 +1,256 @@
+#include "pathindex.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+
+static inline bool inRange(const Enemy* e, QPoint center, int r2, float t){
+    QPointF d = e->getCenterAt(t) - QPointF(center);
+    return d.x()*d.x() + d.y()*d.y() < r2;
+}
+
+void PathIndex::setPath(const QPointF* points, int count){
+    path.assign(points, points + count);
+    distance.assign(count, 0);
+    for(int i = 1; i < count; i++){
+        QPointF d = path[i] - path[i-1];
+        distance[i] = distance[i-1] + std::sqrt(d.x()*d.x() + d.y()*d.y());
+    }
+}
+
+//Waypoint distance plus the projection onto the segment the enemy is walking
+float PathIndex::project(const Enemy* e, float& offset) const{
+    int w = std::min<int>(e->getCurWaypoint(), path.size()-2);
+    QPointF seg = path[w+1] - path[w];
+    QPointF rel = QPointF(e->getRectV().center()) - path[w];
+    float len = distance[w+1] - distance[w];
+    float along = len > 0 ? (rel.x()*seg.x() + rel.y()*seg.y()) / len : 0;
+    along = std::max(0.0f, std::min(len, along));
+
+    float t = len > 0 ? along/len : 0;
+    float dx = rel.x() - t*seg.x();
+    float dy = rel.y() - t*seg.y();
+    offset = std::sqrt(dx*dx + dy*dy);
+    return distance[w] + along;
+}
+
+float PathIndex::progressOf(const Enemy* e) const{
+    float offset;
+    return project(e, offset);
+}
+
+void PathIndex::rebuild(const std::vector<Enemy*>& enemies){
+    scratch.clear();
+    maxOffset = 0;
+    maxStep = 0;
+    for(const auto e : enemies){
+        if(e->isDead())
+            continue;
+        float offset;
+        scratch.push_back(Entry(project(e, offset), e));
+        maxOffset = std::max(maxOffset, offset);
+        QPoint step = e->getRectV().center() - e->getFrom();
+        maxStep = std::max<float>(maxStep, std::sqrt(float(step.x()*step.x() + step.y()*step.y())));
+    }
+    std::sort(scratch.begin(), scratch.end());
+
+    progress.resize(scratch.size());
+    sorted.resize(scratch.size());
+    for(size_t i = 0; i < scratch.size(); i++){
+        progress[i] = scratch[i].progress;
+        sorted[i] = scratch[i].enemy;
+    }
+
+    leafCount = 1;
+    while(leafCount < (int)sorted.size())
+        leafCount *= 2;
+    maxHealth.assign(2*leafCount, INT_MIN);
+    for(size_t i = 0; i < sorted.size(); i++)
+        maxHealth[leafCount+i] = sorted[i]->getHealth();
+    for(int n = leafCount-1; n > 0; n--)
+        maxHealth[n] = std::max(maxHealth[2*n], maxHealth[2*n+1]);
+}
+
+//Smallest and largest path distance inside the circle, from the circle/segment intersections
+bool PathIndex::span(QPoint center, float range, float& lo, float& hi) const{
+    bool found = false;
+    for(size_t i = 0; i+1 < path.size(); i++){
+        QPointF d = path[i+1] - path[i];
+        QPointF f = path[i] - QPointF(center);
+        double a = d.x()*d.x() + d.y()*d.y();
+        double b = 2*(f.x()*d.x() + f.y()*d.y());
+        double c = f.x()*f.x() + f.y()*f.y() - double(range)*range;
+        double disc = b*b - 4*a*c;
+        if(a <= 0 || disc < 0)
+            continue;
+        double root = std::sqrt(disc);
+        double t0 = std::max(0.0, (-b - root)/(2*a));
+        double t1 = std::min(1.0, (-b + root)/(2*a));
+        if(t0 > t1)
+            continue;
+
+        float len = distance[i+1] - distance[i];
+        float from = distance[i] + t0*len - 1;
+        float to = distance[i] + t1*len + 1;
+        lo = found ? std::min(lo, from) : from;
+        hi = found ? std::max(hi, to) : to;
+        found = true;
+    }
+    return found;
+}
+
+//The parts of every segment inside the circle, joined where they meet and then grown or shrunk by pad
+void PathIndex::intervals(QPoint center, float range, float pad, std::vector<float>& out) const{
+    out.clear();
+    for(size_t i = 0; i+1 < path.size(); i++){
+        QPointF d = path[i+1] - path[i];
+        QPointF f = path[i] - QPointF(center);
+        double a = d.x()*d.x() + d.y()*d.y();
+        double b = 2*(f.x()*d.x() + f.y()*d.y());
+        double c = f.x()*f.x() + f.y()*f.y() - double(range)*range;
+        double disc = b*b - 4*a*c;
+        if(range <= 0 || a <= 0 || disc < 0)
+            continue;
+        double root = std::sqrt(disc);
+        double t0 = std::max(0.0, (-b - root)/(2*a));
+        double t1 = std::min(1.0, (-b + root)/(2*a));
+        if(t0 > t1)
+            continue;
+
+        float len = distance[i+1] - distance[i];
+        float from = distance[i] + t0*len;
+        float to = distance[i] + t1*len;
+        if(!out.empty() && from <= out.back())
+            out.back() = std::max(out.back(), to);
+        else{
+            out.push_back(from);
+            out.push_back(to);
+        }
+    }
+
+    size_t kept = 0;
+    for(size_t k = 0; k < out.size(); k += 2){
+        float lo = out[k] - pad;
+        float hi = out[k+1] + pad;
+        if(lo >= hi)
+            continue;
+        if(kept > 0 && lo <= out[kept-1]){
+            out[kept-1] = hi;
+            continue;
+        }
+        out[kept++] = lo;
+        out[kept++] = hi;
+    }
+    out.resize(kept);
+}
+
+//The 1 pixel either way absorbs rounding, the inner stretches give it up rather than claim too much
+void PathIndex::cover(QPoint center, int range, Coverage& c) const{
+    c.range = range;
+    intervals(center, range + PATHINDEX::COVERAGE_MARGIN, 1, c.outer);
+    intervals(center, range - PATHINDEX::COVERAGE_MARGIN, -1, c.inner);
+}
+
+//An enemy within range of the tower has its path point within range+maxOffset, and earlier in the tick
+//it may also have been up to maxStep behind where it was indexed. While that stays inside the margin the
+//tower's own coverage bounds the search, otherwise the span of the widened circle does, with no inner part.
+const Coverage& PathIndex::reach(QPoint center, int range, const Coverage& c, float t, Coverage& fallback) const{
+    float slack = maxOffset + (t < 1 ? maxStep : 0);
+    if(c.range == range && slack <= PATHINDEX::COVERAGE_MARGIN)
+        return c;
+
+    float lo, hi;
+    fallback.range = range;
+    fallback.inner.clear();
+    fallback.outer.clear();
+    if(span(center, range + slack, lo, hi)){
+        fallback.outer.push_back(lo);
+        fallback.outer.push_back(hi);
+    }
+    return fallback;
+}
+
+//Inner stretches are ascending and disjoint, so an odd number of bounds at or below the progress means inside
+bool PathIndex::covers(const Coverage& c, int i, QPoint center, int r2, float t) const{
+    if(sorted[i]->isDead())
+        return false;
+    if((std::upper_bound(c.inner.begin(), c.inner.end(), progress[i]) - c.inner.begin()) % 2 == 1)
+        return true;
+    return inRange(sorted[i], center, r2, t);
+}
+
+void PathIndex::indexRange(float lo, float hi, int& from, int& to) const{
+    from = std::lower_bound(progress.begin(), progress.end(), lo) - progress.begin();
+    to = std::upper_bound(progress.begin(), progress.end(), hi) - progress.begin();
+}
+
+Enemy* PathIndex::first(QPoint center, int range, const Coverage& c, float t) const{
+    if(sorted.empty())
+        return NULL;
+    Coverage fallback;
+    const Coverage& search = reach(center, range, c, t, fallback);
+    for(int k = int(search.outer.size())-2; k >= 0; k -= 2){
+        int from, to;
+        indexRange(search.outer[k], search.outer[k+1], from, to);
+        for(int i = to-1; i >= from; i--)
+            if(covers(search, i, center, range*range, t))
+                return sorted[i];
+    }
+    return NULL;
+}
+
+Enemy* PathIndex::last(QPoint center, int range, const Coverage& c, float t) const{
+    if(sorted.empty())
+        return NULL;
+    Coverage fallback;
+    const Coverage& search = reach(center, range, c, t, fallback);
+    for(size_t k = 0; k < search.outer.size(); k += 2){
+        int from, to;
+        indexRange(search.outer[k], search.outer[k+1], from, to);
+        for(int i = from; i < to; i++)
+            if(covers(search, i, center, range*range, t))
+                return sorted[i];
+    }
+    return NULL;
+}
+
+Enemy* PathIndex::strongest(QPoint center, int range, const Coverage& c, float t) const{
+    if(sorted.empty())
+        return NULL;
+    Coverage fallback;
+    const Coverage& search = reach(center, range, c, t, fallback);
+
+    int best = INT_MIN;
+    Enemy* bestEnemy = NULL;
+    for(size_t k = 0; k < search.outer.size(); k += 2){
+        int from, to;
+        indexRange(search.outer[k], search.outer[k+1], from, to);
+        strongestIn(1, 0, leafCount, from, to, search, center, range*range, t, best, bestEnemy);
+    }
+    return bestEnemy;
+}
+
+//Health only drops during a tick, so a node's stored max is an upper bound and can prune safely
+void PathIndex::strongestIn(int node, int nodeLo, int nodeHi, int from, int to, const Coverage& c, QPoint center,
+                            int r2, float t, int& best, Enemy*& bestEnemy) const{
+    if(nodeHi <= from || nodeLo >= to || maxHealth[node] <= best)
+        return;
+    if(node >= leafCount){
+        Enemy* e = sorted[nodeLo];
+        if(e->getHealth() > best && covers(c, nodeLo, center, r2, t)){
+            best = e->getHealth();
+            bestEnemy = e;
+        }
+        return;
+    }
+    int mid = (nodeLo + nodeHi)/2;
+    if(maxHealth[2*node] >= maxHealth[2*node+1]){
+        strongestIn(2*node, nodeLo, mid, from, to, c, center, r2, t, best, bestEnemy);
+        strongestIn(2*node+1, mid, nodeHi, from, to, c, center, r2, t, best, bestEnemy);
+    }
+    else{
+        strongestIn(2*node+1, mid, nodeHi, from, to, c, center, r2, t, best, bestEnemy);
+        strongestIn(2*node, nodeLo, mid, from, to, c, center, r2, t, best, bestEnemy);
+    }
+}
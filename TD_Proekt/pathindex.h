@@ -0,0 +1,81 @@
+#ifndef PATHINDEX_H
+#define PATHINDEX_H
+
+#include "enemy.h"
+#include <QPointF>
+#include <QPoint>
+#include <vector>
+
+
+namespace PATHINDEX{
+    //How far from the path an enemy may be, counting its last move, for a tower's coverage to stand in for
+    //the distance check. Further out the queries fall back to the span of the widened range circle.
+    const float COVERAGE_MARGIN = 8;
+}
+
+//Stretches of the path a tower covers, as ascending lo,hi pairs of path distance. The path never changes,
+//so these are worked out when the tower is placed and again only after its range is upgraded.
+class Coverage
+{
+public:
+    Coverage() : range(-1) {}
+
+    int range;                 //range the intervals are for, -1 before the first time
+    std::vector<float> outer;  //path within range+margin: an enemy in range has its path point in here
+    std::vector<float> inner;  //path within range-margin: an enemy with its path point in here is in range
+};
+
+//Live enemies ordered by how far they have walked along the navigation path, rebuilt once per tick.
+//Tower queries narrow the order down to the stretch of path the tower can reach, so "first" and "last"
+//are a binary search plus a short walk, and "strongest" descends a max-health segment tree over that stretch.
+//Queries take a moment t within the last tick and test each enemy where it was at that point of its move.
+//Given the tower's Coverage they only search the stretches it covers, and an enemy whose progress falls in
+//an inner stretch is taken without measuring its distance.
+class PathIndex
+{
+public:
+    PathIndex() : leafCount(1), maxOffset(0), maxStep(0) {}
+
+    void setPath(const QPointF* points, int count);
+    void rebuild(const std::vector<Enemy*>& enemies);
+
+    float progressOf(const Enemy* e) const;
+    bool span(QPoint center, float range, float& lo, float& hi) const;
+    void cover(QPoint center, int range, Coverage& c) const;
+
+    Enemy* first(QPoint center, int range, const Coverage& c, float t) const;
+    Enemy* last(QPoint center, int range, const Coverage& c, float t) const;
+    Enemy* strongest(QPoint center, int range, const Coverage& c, float t) const;
+
+    inline int size() const { return sorted.size(); }
+    inline float getMaxStep() const { return maxStep; }
+private:
+    std::vector<QPointF> path;
+    std::vector<float> distance;  //path length up to each waypoint
+
+    std::vector<float> progress;  //ascending
+    std::vector<Enemy*> sorted;
+    std::vector<int> maxHealth;   //segment tree over sorted, leaves start at leafCount
+    int leafCount;
+    float maxOffset;              //furthest any indexed enemy sits from its point on the path
+    float maxStep;                //longest last move of any indexed enemy
+
+    class Entry{
+    public:
+        Entry(float p, Enemy* e) : progress(p), enemy(e) {}
+        bool operator<(const Entry& o) const { return progress < o.progress; }
+        float progress;
+        Enemy* enemy;
+    };
+    std::vector<Entry> scratch;
+
+    float project(const Enemy* e, float& offset) const;
+    void intervals(QPoint center, float range, float pad, std::vector<float>& out) const;
+    const Coverage& reach(QPoint center, int range, const Coverage& c, float t, Coverage& fallback) const;
+    bool covers(const Coverage& c, int i, QPoint center, int r2, float t) const;
+    void indexRange(float lo, float hi, int& from, int& to) const;
+    void strongestIn(int node, int nodeLo, int nodeHi, int from, int to, const Coverage& c, QPoint center, int r2,
+                     float t, int& best, Enemy*& bestEnemy) const;
+};
+
+#endif // PATHINDEX_H
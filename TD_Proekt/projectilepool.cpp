@@ -0,0 +1,82 @@
+#include "projectilepool.h"
+#include <cmath>
+
+
+ProjectilePool::ProjectilePool(int capacity) : capacity(capacity), count(0),
+    x(capacity), y(capacity), speed(capacity), damage(capacity), type(capacity), target(capacity)
+{
+    hits.reserve(capacity);
+}
+
+bool ProjectilePool::fire(QPointF from, Enemy* e, int d, int t, float s){
+    if(count == capacity)
+        return false;
+
+    x[count] = from.x();
+    y[count] = from.y();
+    speed[count] = s;
+    damage[count] = d;
+    type[count] = t;
+    target[count] = e;
+    count++;
+    return true;
+}
+
+void ProjectilePool::retire(int i){
+    count--;
+    x[i] = x[count];
+    y[i] = y[count];
+    speed[i] = speed[count];
+    damage[i] = damage[count];
+    type[i] = type[count];
+    target[i] = target[count];
+}
+
+//Moves every projectile towards its target and returns the ones that arrived this tick.
+//The caller applies the hits, the list stays valid until the next call.
+const std::vector<ProjectileHit>& ProjectilePool::integrate(){
+    hits.clear();
+
+    int i = 0;
+    while(i < count){
+        Enemy* e = target[i];
+        if(e->isDead()){
+            retire(i);
+            continue;
+        }
+
+        QPoint c = e->getRect()->center();
+        float dx = c.x() - x[i];
+        float dy = c.y() - y[i];
+        float dist2 = dx*dx + dy*dy;
+        float s = speed[i];
+
+        if(dist2 <= s*s){
+            hits.push_back(ProjectileHit(e, damage[i], type[i]));
+            retire(i);
+            continue;
+        }
+
+        float k = s / std::sqrt(dist2);
+        x[i] += dx*k;
+        y[i] += dy*k;
+        i++;
+    }
+    return hits;
+}
+
+//Has to run before dead enemies are deleted, otherwise projectiles would keep dangling targets
+void ProjectilePool::dropDeadTargets(){
+    int i = 0;
+    while(i < count){
+        if(target[i]->isDead())
+            retire(i);
+        else
+            i++;
+    }
+}
+
+void ProjectilePool::clear(){
+    count = 0;
+    hits.clear();
+}
@@ -0,0 +1,56 @@
+#ifndef PROJECTILEPOOL_H
+#define PROJECTILEPOOL_H
+
+#include "enemy.h"
+#include <QPointF>
+#include <vector>
+
+
+namespace PROJECTILE{
+    const int CAPACITY = 16384;
+}
+
+class ProjectileHit
+{
+public:
+    ProjectileHit(Enemy* e, int d, int t) : target(e), damage(d), type(t) {}
+
+    Enemy* target;
+    int damage;
+    int type;
+};
+
+//Homing projectiles stored as parallel arrays. Live projectiles are always packed into [0, size()),
+//a retired slot is filled by the last one, so a tick is one linear pass with no allocation.
+class ProjectilePool
+{
+public:
+    ProjectilePool(int capacity = PROJECTILE::CAPACITY);
+
+    bool fire(QPointF from, Enemy* target, int damage, int type, float speed);
+    const std::vector<ProjectileHit>& integrate();
+    void dropDeadTargets();
+    void clear();
+
+    inline int size() const { return count; }
+    inline int getCapacity() const { return capacity; }
+    inline float getX(int i) const { return x[i]; }
+    inline float getY(int i) const { return y[i]; }
+    inline int getType(int i) const { return type[i]; }
+private:
+    int capacity;
+    int count;
+
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> speed;
+    std::vector<int> damage;
+    std::vector<int> type;
+    std::vector<Enemy*> target;
+
+    std::vector<ProjectileHit> hits;
+
+    void retire(int i);
+};
+
+#endif // PROJECTILEPOOL_H
@@ -0,0 +1,159 @@
+#include "savegame.h"
+
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDir>
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+using namespace SAVEGAME;
+
+static_assert(sizeof(Header) == 16*4, "Header layout changed, bump SAVEGAME::VERSION");
+static_assert(sizeof(StatsRecord) == 5*4, "StatsRecord layout changed, bump SAVEGAME::VERSION");
+static_assert(sizeof(TowerRecord) == 5*4, "TowerRecord layout changed, bump SAVEGAME::VERSION");
+static_assert(sizeof(EnemyRecord) == 7*4, "EnemyRecord layout changed, bump SAVEGAME::VERSION");
+static_assert(sizeof(EffectRecord) == 4*4, "EffectRecord layout changed, bump SAVEGAME::VERSION");
+static_assert(sizeof(SpawnRecord) == 3*4, "SpawnRecord layout changed, bump SAVEGAME::VERSION");
+
+static bool fits(quint32 offset, quint32 count, quint32 size, quint32 fileSize){
+    return offset % 4 == 0 && offset <= fileSize && count <= (fileSize - offset)/size;
+}
+
+SaveGame::SaveGame(QString filePath) : file(filePath), data(NULL), header(NULL){
+    if(!file.open(QIODevice::ReadOnly) || file.size() < (qint64)sizeof(Header))
+        return;
+
+    data = file.map(0, file.size());
+    if(data == NULL)
+        return;
+
+    const Header* h = reinterpret_cast<const Header*>(data);
+    quint32 size = file.size();
+    if(std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->version != VERSION || h->fileSize != size)
+        return;
+    if(!fits(h->statsOffset, h->statsCount, sizeof(StatsRecord), size) ||
+       !fits(h->towerOffset, h->towerCount, sizeof(TowerRecord), size) ||
+       !fits(h->enemyOffset, h->enemyCount, sizeof(EnemyRecord), size) ||
+       !fits(h->effectOffset, h->effectCount, sizeof(EffectRecord), size) ||
+       !fits(h->spawnOffset, h->spawnCount, sizeof(SpawnRecord), size))
+        return;
+
+    header = h;
+}
+
+SaveGame::~SaveGame(){
+    if(data != NULL)
+        file.unmap(data);
+}
+
+QString SaveGame::defaultPath(){
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dir);
+    return QDir(dir).filePath(FILE_NAME);
+}
+
+bool SaveGame::write(QString filePath, const Simulation& sim){
+    qint64 tick = sim.getTick();
+    const std::vector<Tower*>& towers = sim.getTowers();
+    const std::vector<Enemy*>& enemies = sim.getEnemies();
+    const StatusEffects& effects = sim.getEffects();
+    const SpawnStream& spawns = sim.getSpawns();
+
+    //Effects refer to their enemy by its place among the saved ones
+    std::map<const Enemy*, int> saved;
+    for(const auto e : enemies)
+        if(!e->isDead())
+            saved.insert(std::make_pair(e, int(saved.size())));
+    size_t liveEffects = 0;
+    for(int k = 0; k < EFFECT_COUNT; k++)
+        for(int i = 0; i < effects.size(static_cast<Effect>(k)); i++)
+            if(saved.count(effects.getTarget(static_cast<Effect>(k), i)) != 0)
+                liveEffects++;
+    const std::vector<SpawnGroup>& spawnList = spawns.getGroups();
+
+    Header h;
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.wave = sim.getWave();
+    h.score = sim.getScore();
+    h.statsCount = Tower::getTypeCount();
+    h.towerCount = towers.size();
+    h.enemyCount = saved.size();
+    h.effectCount = liveEffects;
+    h.spawnCount = spawnList.size();
+    h.statsOffset = sizeof(Header);
+    h.towerOffset = h.statsOffset + h.statsCount*sizeof(StatsRecord);
+    h.enemyOffset = h.towerOffset + h.towerCount*sizeof(TowerRecord);
+    h.effectOffset = h.enemyOffset + h.enemyCount*sizeof(EnemyRecord);
+    h.spawnOffset = h.effectOffset + h.effectCount*sizeof(EffectRecord);
+    h.spawnDelayMs = std::max<qint64>(0, spawns.getDueMs() - tick*SIM::TICK_MS);
+    h.fileSize = h.spawnOffset + h.spawnCount*sizeof(SpawnRecord);
+
+    //Build the whole image in memory so the file is written with a single call
+    QByteArray buffer(h.fileSize, 0);
+    char* out = buffer.data();
+    std::memcpy(out, &h, sizeof(Header));
+
+    StatsRecord* stats = reinterpret_cast<StatsRecord*>(out + h.statsOffset);
+    for(int i = 0; i < Tower::getTypeCount(); i++){
+        stats[i].type = i;
+        sim.getUpgrades().getCounts(static_cast<Type>(i), stats[i].damageUpgrades, stats[i].rangeUpgrades, stats[i].coolDownUpgrades, stats[i].built);
+    }
+
+    TowerRecord* t = reinterpret_cast<TowerRecord*>(out + h.towerOffset);
+    for(const auto tower : towers){
+        t->type = tower->getType();
+        t->x = tower->getRect()->x();
+        t->y = tower->getRect()->y();
+        t->targeting = static_cast<qint32>(tower->getTargeting());
+        t->coolDown = std::max(0.0, tower->getReadyTime() - tick);
+        t++;
+    }
+
+    EnemyRecord* e = reinterpret_cast<EnemyRecord*>(out + h.enemyOffset);
+    for(const auto enemy : enemies){
+        if(enemy->isDead())
+            continue;
+        e->type = enemy->getArchetype();
+        e->x = enemy->getRect()->x();
+        e->y = enemy->getRect()->y();
+        e->health = enemy->getHealth();
+        e->waypoint = enemy->getCurWaypoint();
+        e->faceRight = enemy->isFacingRight();
+        e->stride = enemy->getStride();
+        e++;
+    }
+
+    EffectRecord* f = reinterpret_cast<EffectRecord*>(out + h.effectOffset);
+    for(int k = 0; k < EFFECT_COUNT; k++){
+        for(int i = 0; i < effects.size(static_cast<Effect>(k)); i++){
+            auto at = saved.find(effects.getTarget(static_cast<Effect>(k), i));
+            if(at == saved.end())
+                continue;
+            f->effect = k;
+            f->enemy = at->second;
+            f->magnitude = effects.getMagnitude(static_cast<Effect>(k), i);
+            f->ticksLeft = std::max<qint64>(0, effects.getExpiry(static_cast<Effect>(k), i) - tick);
+            f++;
+        }
+    }
+
+    SpawnRecord* s = reinterpret_cast<SpawnRecord*>(out + h.spawnOffset);
+    for(const auto& g : spawnList){
+        s->type = g.type;
+        s->count = g.count;
+        s->spacing = g.spacing;
+        s++;
+    }
+
+    //QSaveFile writes to a temporary file and renames it over the old save on commit
+    QSaveFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+    if(file.write(buffer) != buffer.size()){
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
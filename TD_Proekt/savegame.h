@@ -0,0 +1,101 @@
+#ifndef SAVEGAME_H
+#define SAVEGAME_H
+
+#include "simulation.h"
+#include <QFile>
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+
+
+namespace SAVEGAME{
+    const char MAGIC[4] = {'T','D','S','V'};
+    const quint32 VERSION = 4;
+    const QString FILE_NAME = "savegame.bin";
+
+    //Fixed layout records, written and read in native byte order. Every record is a multiple of 4 bytes
+    //so the arrays that follow the header stay aligned inside the mapped file.
+    struct Header{
+        char magic[4];
+        quint32 version;
+        quint32 fileSize;
+        qint32 wave;
+        qint32 score;
+        quint32 statsCount;
+        quint32 towerCount;
+        quint32 enemyCount;
+        quint32 effectCount;
+        quint32 spawnCount;
+        quint32 statsOffset;
+        quint32 towerOffset;
+        quint32 enemyOffset;
+        quint32 effectOffset;
+        quint32 spawnOffset;
+        qint32 spawnDelayMs;  //until the next enemy of the pending wave spawns
+    };
+
+    struct StatsRecord{
+        qint32 type;
+        qint32 damageUpgrades;
+        qint32 rangeUpgrades;
+        qint32 coolDownUpgrades;
+        qint32 built;
+    };
+
+    struct TowerRecord{
+        qint32 type;
+        qint32 x;
+        qint32 y;
+        qint32 targeting;
+        float coolDown;  //ticks until the tower may fire again
+    };
+
+    struct EnemyRecord{
+        qint32 type;
+        qint32 x;
+        qint32 y;
+        qint32 health;
+        qint32 waypoint;
+        qint32 faceRight;
+        float stride;  //fractional movement owed, slows come back with the effect records
+    };
+
+    struct EffectRecord{
+        qint32 effect;
+        qint32 enemy;  //index into the enemy records
+        float magnitude;
+        qint32 ticksLeft;
+    };
+
+    struct SpawnRecord{
+        qint32 type;
+        qint32 count;
+        qint32 spacing;
+    };
+}
+
+class SaveGame
+{
+public:
+    SaveGame(QString filePath);
+    ~SaveGame();
+
+    static QString defaultPath();
+    static bool write(QString filePath, const Simulation& sim);
+
+    inline bool isValid() const { return header != NULL; }
+    inline const SAVEGAME::Header* getHeader() const { return header; }
+    inline const SAVEGAME::StatsRecord* getStats() const { return records<SAVEGAME::StatsRecord>(header->statsOffset); }
+    inline const SAVEGAME::TowerRecord* getTowers() const { return records<SAVEGAME::TowerRecord>(header->towerOffset); }
+    inline const SAVEGAME::EnemyRecord* getEnemies() const { return records<SAVEGAME::EnemyRecord>(header->enemyOffset); }
+    inline const SAVEGAME::EffectRecord* getEffects() const { return records<SAVEGAME::EffectRecord>(header->effectOffset); }
+    inline const SAVEGAME::SpawnRecord* getSpawnList() const { return records<SAVEGAME::SpawnRecord>(header->spawnOffset); }
+private:
+    QFile file;
+    uchar* data;
+    const SAVEGAME::Header* header;
+
+    template<class T> inline const T* records(quint32 offset) const { return reinterpret_cast<const T*>(data + offset); }
+};
+
+#endif // SAVEGAME_H
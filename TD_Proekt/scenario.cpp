@@ -0,0 +1,45 @@
+#include "scenario.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+bool Scenario::parse(const QStringList& args, Scenario& out){
+    int at = args.indexOf(SCENARIO::ARGUMENT);
+    if(at < 0)
+        return false;
+
+    bool ok = false;
+    int enemies = at+1 < args.size() ? args[at+1].toInt(&ok) : 0;
+    if(ok && enemies > 0)
+        out.enemies = enemies;
+    ok = false;
+    int ticks = at+2 < args.size() ? args[at+2].toInt(&ok) : 0;
+    if(ok && ticks > 0)
+        out.ticks = ticks;
+    out.quitWhenDone = true;
+    return true;
+}
+
+//Nearest rank percentiles, in milliseconds
+std::string Scenario::summarize(const char* name, std::vector<qint64> samples){
+    if(samples.empty())
+        return std::string(name) + ": no samples";
+    std::sort(samples.begin(), samples.end());
+    //Nearest rank: the smallest sample with at least p of them at or below it. The epsilon keeps products like
+    //0.9*10 from rounding up a whole rank.
+    auto at = [&samples](double p){
+        double rank = std::ceil(p*samples.size() - 1e-9);
+        return samples[std::min<size_t>(samples.size()-1, size_t(std::max(1.0, rank)) - 1)] / 1e6;
+    };
+
+    char line[160];
+    std::snprintf(line, sizeof(line), "%s x%zu: p50 %.3f  p90 %.3f  p99 %.3f  max %.3f ms",
+                  name, samples.size(), at(0.5), at(0.9), at(0.99), samples.back() / 1e6);
+    return line;
+}
+
+std::string Scenario::report() const{
+    return "scenario " + std::to_string(enemies) + " enemies, " + std::to_string(ticks) + " ticks\n" +
+           summarize("tick", tickNs) + "\n" + summarize("frame", frameNs);
+}
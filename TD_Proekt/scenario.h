@@ -0,0 +1,46 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <QStringList>
+#include <QtGlobal>
+#include <string>
+#include <vector>
+
+
+namespace SCENARIO{
+    const QString ARGUMENT = "--scenario";
+    const int DEFAULT_ENEMIES = 2000;
+    const int DEFAULT_TICKS = 3000;
+    const unsigned int RANDOM_SEED = 12345;  //fixed, so two runs of the same scenario simulate the same game
+}
+
+//A reproducible load test: enemies spawned back to back, a tower on every free tile, a fixed number of
+//simulation ticks. Collects how long every tick and every painted frame took.
+class Scenario
+{
+public:
+    Scenario(int enemies = SCENARIO::DEFAULT_ENEMIES, int ticks = SCENARIO::DEFAULT_TICKS) :
+        enemies(enemies), ticks(ticks), quitWhenDone(false) {}
+
+    //--scenario [enemies] [ticks], false when the argument is not there
+    static bool parse(const QStringList& args, Scenario& out);
+
+    inline int getEnemies() const { return enemies; }
+    inline int getTicks() const { return ticks; }
+    inline bool isQuitWhenDone() const { return quitWhenDone; }
+    inline bool isDone() const { return int(tickNs.size()) >= ticks; }
+
+    inline void recordTick(qint64 ns) { tickNs.push_back(ns); }
+    inline void recordFrame(qint64 ns) { frameNs.push_back(ns); }
+    std::string report() const;
+private:
+    int enemies;
+    int ticks;
+    bool quitWhenDone;
+    std::vector<qint64> tickNs;
+    std::vector<qint64> frameNs;
+
+    static std::string summarize(const char* name, std::vector<qint64> samples);
+};
+
+#endif // SCENARIO_H
@@ -0,0 +1,401 @@
+#include "simulation.h"
+#include "config.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+Simulation::Simulation() : simTick(0), wave(0), score(0), enemyCount(0), stress(0), outcome(PLAYING),
+    enemyGrid(QRect(0, 0, CONSTANTS::SCREEN_WIDTH, CONSTANTS::SCREEN_HEIGHT), 32)
+{
+    for(int i = 0; i < tiles.size(); i++){
+        tiles.setPath(i, CONSTANTS::MAP[i] != 0);
+        if(CONSTANTS::MAP[i] != 0)
+            navPath[CONSTANTS::MAP[i]-1] = tiles.rectOf(i).center();
+    }
+    pathIndex.setPath(navPath, CONSTANTS::PATH_TILE_COUNT);
+    upgrades.reset();
+}
+
+Simulation::~Simulation(){
+    clear();
+}
+
+//Tower and enemy archetypes, a file next to the executable overrides the compiled-in table.
+//Has to run before any Simulation is used, and never while one is ticking.
+void Simulation::loadTables(){
+    if(!TowerTable::load(Config::locate(TOWER::CONFIG_FILE)))
+        TowerTable::load(":/" + TOWER::CONFIG_FILE);
+    if(!EnemyTable::load(Config::locate(ENEMY::CONFIG_FILE)))
+        EnemyTable::load(":/" + ENEMY::CONFIG_FILE);
+}
+
+//Back to an empty map before the first wave
+void Simulation::clear(){
+    removeEnemies();
+    upgrades.reset();
+    for(auto& t : towers)
+        delete t;
+    towers.clear();
+    tiles.clearOccupied();
+    spawns.clear();
+    hits.clear();
+    simTick = 0;
+    wave = 0;
+    score = 0;
+    enemyCount = 0;
+    stress = 0;
+    outcome = PLAYING;
+}
+
+void Simulation::removeEnemies(){
+    projectiles.clear();
+    effects.clear();
+    for(auto& e : enemies)
+        delete e;
+    enemies.clear();
+}
+
+void Simulation::newWave(){
+    wave++;
+    removeEnemies();
+    queueSpawns(wave_generator.generateSpawnList(wave), SIM::FIRST_SPAWN_MS);
+}
+
+//Enemies split evenly over the archetypes and spawned back to back. Whenever the last one is gone the
+//same wave starts over, so the load never drops and enemies that get through just leave.
+void Simulation::startStress(int count){
+    stress = count;
+    std::vector<SpawnGroup> groups;
+    int types = EnemyTable::size();
+    for(int t = 0; t < types; t++)
+        groups.push_back(SpawnGroup(t, count/types + (t < count%types ? 1 : 0), SIM::STRESS_SPACING_MS));
+    queueSpawns(groups, SIM::TICK_MS);
+}
+
+//Enemies still alive on the map count towards the wave, so a restored game ends its wave as it would have
+void Simulation::queueSpawns(const std::vector<SpawnGroup>& groups, int delayMs){
+    spawns.start(groups, simTick*SIM::TICK_MS + delayMs);
+    enemyCount = spawns.getRemaining() + std::count_if(enemies.begin(), enemies.end(), [](const Enemy* e){ return !e->isDead(); });
+    outcome = PLAYING;
+}
+
+//Takes ownership, the tile under it can no longer be built on
+void Simulation::addTower(Tower* t){
+    int tile = tiles.at(t->getRect()->topLeft());
+    if(tile >= 0)
+        tiles.setOccupied(tile, true);
+    cover(t);
+    towers.push_back(t);
+}
+
+//Range upgrades apply to every tower of the type, so a tower notices the change the next time it looks for a target
+void Simulation::cover(Tower* t){
+    int range = upgrades.getRange(t->getType());
+    if(t->getCoverage().range == range)
+        return;
+    Coverage c;
+    pathIndex.cover(t->getRect()->center(), range, c);
+    t->setCoverage(c);
+}
+
+void Simulation::addEnemy(Enemy* e){
+    enemies.push_back(e);
+}
+
+void Simulation::tick(){
+    simTick++;
+    hits.clear();
+    spawner();
+    const std::vector<EffectHit>& burns = effects.update(simTick, simTick % SIM::toTicks(STATUS::BURN_PERIOD_MS) == 0);
+    moveEnemies();
+    if(outcome == LOST)
+        return;
+
+    enemyGrid.rebuild(enemies);
+    pathIndex.rebuild(enemies);
+    raycast();
+    updateProjectiles();
+    applyBurns(burns);
+    cleanEnemyList();
+}
+
+//Every enemy that has come due, several per tick when the spacing is shorter than a tick
+void Simulation::spawner(){
+    while(spawns.isDue(simTick*SIM::TICK_MS))
+        enemies.push_back(new Enemy(wave_generator.takeNext(spawns), navPath[0]));
+}
+
+void Simulation::moveEnemies(){
+    for(auto& e : enemies){
+        if(e->getRect()->contains(navPath[CONSTANTS::PATH_TILE_COUNT - 1].toPoint())){
+            //A stress run only measures, enemies that get through just leave
+            if(stress > 0){
+                if(!e->isDead()){
+                    e->setDead(true);
+                    enemyGone();
+                }
+                continue;
+            }
+            outcome = LOST;
+            break;
+        }
+        //Walked a pixel at a time, turning at the same spots whatever the tick length
+        QPoint end = navPath[CONSTANTS::PATH_TILE_COUNT - 1].toPoint();
+        for(int steps = e->startMove(SIM::SPEED_SCALE); steps > 0 && !e->getRect()->contains(end); steps--){
+            if(e->getRect()->contains(navPath[e->getCurWaypoint()+1].toPoint()))
+                e->incrementCurWaypoint();
+            e->step(navPath[e->getCurWaypoint()+1]);
+        }
+    }
+}
+
+//Folds everything a tick can change into h
+void Simulation::hash(StateHash& h) const{
+    h.add(simTick);
+    h.add(spawns.getDueMs());
+    h.add(int(outcome));
+    h.add(score);
+    h.add(wave);
+    h.add(enemyCount);
+    for(const auto& g : spawns.getGroups()){
+        h.add(g.type);
+        h.add(g.count);
+        h.add(g.spacing);
+    }
+    for(const auto e : enemies){
+        h.add(e->getArchetype());
+        h.add(e->getRect()->x());
+        h.add(e->getRect()->y());
+        h.add(e->getHealth());
+        h.add(e->getCurWaypoint());
+        h.add(e->isDead());
+        h.add(e->getSpeedFactor());
+        h.add(e->getStride());
+    }
+    for(const auto t : towers){
+        h.add(int(t->getType()));
+        h.add(int(t->getTargeting()));
+        h.add(t->getReadyTime());
+    }
+    for(int t = 0; t < Tower::getTypeCount(); t++){
+        int d, r, s, built;
+        upgrades.getCounts(static_cast<Type>(t), d, r, s, built);
+        h.add(d);
+        h.add(r);
+        h.add(s);
+        h.add(built);
+        h.add(upgrades.getDamage(static_cast<Type>(t)));
+        h.add(upgrades.getRange(static_cast<Type>(t)));
+        h.add(upgrades.getCoolDown(static_cast<Type>(t)));
+    }
+    for(int i = 0; i < projectiles.size(); i++){
+        h.add(projectiles.getX(i));
+        h.add(projectiles.getY(i));
+        h.add(projectiles.getType(i));
+    }
+    effects.hash(h);
+    h.add(quint64(wave_generator.getEngine().getSeed()));
+    h.add(wave_generator.getEngine().getDraws());
+}
+
+//Target of a tower that became ready at fraction `ready` of this tick, and the fraction `when` it fires at.
+//The enemies in range at `ready` come first. Failing that, every enemy's move is swept against the range
+//circle and the earliest to enter after `ready` is taken, so nothing crosses a range between two ticks unseen.
+Enemy* Simulation::selectTarget(Tower* t, float ready, float& when){
+    when = ready;
+    Enemy* e = targetAt(t, ready);
+    if(e != NULL || ready >= 1)
+        return e;
+
+    QPoint center = t->getRect()->center();
+    int range = upgrades.getRange(t->getType());
+    victims.clear();
+    enemyGrid.queryRadius(center, range + std::ceil(pathIndex.getMaxStep()), victims);
+    when = 1;
+    for(auto& v : victims){
+        float in, out;
+        if(!v->rangeWindow(center, range, in, out) || out < ready)
+            continue;
+        in = std::max(in, ready);
+        if(e == NULL || in < when || (in == when && outranks(t->getTargeting(), v, e, center, in))){
+            when = in;
+            e = v;
+        }
+    }
+    return e;
+}
+
+//Best target in range at fraction `when` of this tick
+Enemy* Simulation::targetAt(Tower* t, float when){
+    QPoint center = t->getRect()->center();
+    int range = upgrades.getRange(t->getType());
+
+    switch(t->getTargeting()){
+        case Targeting::FIRST:
+            return pathIndex.first(center, range, t->getCoverage(), when);
+        case Targeting::LAST:
+            return pathIndex.last(center, range, t->getCoverage(), when);
+        case Targeting::STRONGEST:
+            return pathIndex.strongest(center, range, t->getCoverage(), when);
+        case Targeting::CLOSEST:{
+            victims.clear();
+            enemyGrid.queryRadius(center, range + (when < 1 ? std::ceil(pathIndex.getMaxStep()) : 0), victims);
+            Enemy* closest = NULL;
+            float best = upgrades.getRangeSq(t->getType());
+            for(auto& v : victims){
+                QPointF d = v->getCenterAt(when) - QPointF(center);
+                if(d.x()*d.x() + d.y()*d.y() < best){
+                    best = d.x()*d.x() + d.y()*d.y();
+                    closest = v;
+                }
+            }
+            return closest;
+        }
+    }
+    return NULL;
+}
+
+//Tie break between two enemies entering range at the same moment
+bool Simulation::outranks(Targeting targeting, Enemy* a, Enemy* b, QPoint center, float when) const{
+    switch(targeting){
+        case Targeting::FIRST:
+            return pathIndex.progressOf(a) > pathIndex.progressOf(b);
+        case Targeting::LAST:
+            return pathIndex.progressOf(a) < pathIndex.progressOf(b);
+        case Targeting::STRONGEST:
+            return a->getHealth() > b->getHealth();
+        case Targeting::CLOSEST:{
+            QPointF da = a->getCenterAt(when) - QPointF(center);
+            QPointF db = b->getCenterAt(when) - QPointF(center);
+            return da.x()*da.x() + da.y()*da.y() < db.x()*db.x() + db.y()*db.y();
+        }
+    }
+    return false;
+}
+
+void Simulation::raycast(){
+    for(auto& t : towers){
+        if(t->isCoolDown(simTick))
+            continue;
+        cover(t);
+        //This tick runs from simTick-1 to simTick, the cooldown may have run out partway through it
+        float ready = std::max(0.0, t->getReadyTime() - (simTick - 1));
+        float when;
+        Enemy* e = selectTarget(t, ready, when);
+        if(e == NULL)
+            continue;
+
+        t->setReadyTime(simTick - 1 + when + upgrades.getCoolDown(t->getType())/double(SIM::TICK_MS));
+
+        const TowerArchetype& a = TowerTable::get(t->getType());
+        int damage = upgrades.getDamage(t->getType());
+        QPointF from = t->getRect()->center();
+        if(a.area == Area_Type::CONE){
+            victims.clear();
+            enemyGrid.queryCone(t->getRect()->center(), e->getCenterAt(when).toPoint() - t->getRect()->center(),
+                                upgrades.getRange(t->getType()), a.coneCos, victims);
+            for(auto& v : victims){
+                hitEnemy(v, damage);
+                applyEffect(v, t->getType());
+            }
+            continue;
+        }
+
+        //A shot fired partway through the tick has already flown for the rest of it
+        float speed = a.projectileSpeed * SIM::SPEED_SCALE;
+        QPointF aim = QPointF(e->getRect()->center()) - from;
+        float length = std::sqrt(aim.x()*aim.x() + aim.y()*aim.y());
+        if(length > 0)
+            from += aim * std::min(1.0f, (1 - when)*speed/length);
+
+        //Pool full: resolve the shot on the spot rather than lose it
+        if(!projectiles.fire(from, e, damage, t->getType(), speed)){
+            hitEnemy(e, damage);
+            applyEffect(e, t->getType());
+        }
+    }
+}
+
+//Expects enemyGrid to be current for this tick, cleanEnemyList runs once after the whole batch
+void Simulation::updateProjectiles(){
+    for(const auto& h : projectiles.integrate()){
+        if(h.target->isDead())
+            continue;
+        const TowerArchetype& a = TowerTable::get(h.type);
+        if(a.area == Area_Type::SPLASH){
+            victims.clear();
+            enemyGrid.queryRadius(h.target->getRect()->center(), a.splashRadius, victims);
+            for(auto& v : victims){
+                hitEnemy(v, h.damage);
+                applyEffect(v, h.type);
+            }
+        }
+        else{
+            hitEnemy(h.target, h.damage);
+            applyEffect(h.target, h.type);
+        }
+    }
+}
+
+void Simulation::applyEffect(Enemy* e, int towerType){
+    const TowerArchetype& a = TowerTable::get(towerType);
+    if(a.effect != EFFECT_NONE && !e->isDead())
+        effects.apply(a.effect, e, a.effectStrength, simTick + SIM::toTicks(a.effectMs));
+}
+
+//Burns were collected before this tick's move, their targets may have died since
+void Simulation::applyBurns(const std::vector<EffectHit>& burns){
+    for(const auto& b : burns)
+        if(!b.target->isDead())
+            hitEnemy(b.target, b.damage);
+}
+
+//Applies damage and death bookkeeping. Dead enemies stay in the list until the next cleanEnemyList,
+//so a batch of hits can be applied without invalidating the rest of the batch.
+void Simulation::hitEnemy(Enemy* e, int damage){
+    e->inflictDamage(damage);
+    hits.push_back(DamageHit(QPoint(e->getRect()->center().x(), e->getRect()->top()), damage));
+
+    if(e->getHealth() <= 0){
+        e->setDead(true);
+        enemyGone();
+    }
+}
+
+void Simulation::enemyGone(){
+    enemyCount--;
+    if(enemyCount > 0)
+        return;
+    //End wave, a stress run keeps the load up instead
+    if(stress > 0)
+        startStress(stress);
+    else
+        outcome = WAVE_CLEARED;
+}
+
+void Simulation::cleanEnemyList(){
+    bool anyDead = false;
+    for(const auto e : enemies){
+        if(e->isDead()){
+            anyDead = true;
+            break;
+        }
+    }
+    if(!anyDead)
+        return;
+
+    projectiles.dropDeadTargets();
+    effects.dropDeadTargets();
+
+    size_t kept = 0;
+    for(size_t i = 0; i<enemies.size(); i++){
+        if(enemies[i]->isDead()){
+            score += enemies[i]->getScore();
+            delete enemies[i];
+        }
+        else
+            enemies[kept++] = enemies[i];
+    }
+    enemies.resize(kept);
+}
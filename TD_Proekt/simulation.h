@@ -0,0 +1,133 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "enemy.h"
+#include "tower.h"
+#include "wavegenerator.h"
+#include "projectilepool.h"
+#include "statuseffects.h"
+#include "enemygrid.h"
+#include "pathindex.h"
+#include "tilegrid.h"
+#include "statehash.h"
+#include <QPoint>
+#include <QPointF>
+#include <QtGlobal>
+#include <vector>
+
+
+//The simulation always advances in fixed ticks, faster speeds only run more of them per displayed frame.
+//Enemies walk the same pixels at any tick length, and towers sweep each move against their range and fire
+//at the moment within the tick it entered, so a longer TICK_MS lets nothing slip through a range unseen.
+//Projectile impacts, effect expiry and burns still land on whole ticks though, so changing TICK_MS does
+//change when hits land: compare --hash-log runs before relying on it.
+namespace SIM{
+    const int TICK_MS = 30;
+    const int SPEED_TICK_MS = 30;  //enemy and projectile speeds are configured per this many ms
+    const float SPEED_SCALE = float(TICK_MS)/SPEED_TICK_MS;
+    const int FRAME_MS = 10;
+    const int SPEEDS[] = {1, 2, 4, 16};
+    const int SPEED_COUNT = 4;
+    const int MAX_TICKS_PER_FRAME = 64;
+    const int FIRST_SPAWN_MS = 2000;
+    const int STRESS_SPACING_MS = 30;  //one enemy per tick
+    const int DECAL_RISE_MS = 150;
+    const int DECAL_LIFE_MS = 1000;
+
+    inline int toTicks(int ms) { return (ms + TICK_MS - 1)/TICK_MS; }
+}
+
+//Damage dealt during the last tick, where the enemy's head was when it landed
+class DamageHit
+{
+public:
+    DamageHit(QPoint p, int d) : at(p), damage(d) {}
+
+    QPoint at;
+    int damage;
+};
+
+//One game's rules and state with nothing on screen: the map, its towers and their upgrades, the current
+//wave and everything the ticks move. Game drives one for the player and BatchRunner runs many side by side
+//on worker threads, so nothing in here may touch widgets, the event loop or mutable statics.
+class Simulation
+{
+public:
+    enum Outcome {PLAYING, WAVE_CLEARED, LOST};
+
+    Simulation();
+    ~Simulation();
+
+    static void loadTables();
+
+    void clear();
+    void newWave();
+    void startStress(int enemies);
+    void tick();
+    void hash(StateHash& h) const;
+
+    void addTower(Tower* t);
+    void addEnemy(Enemy* e);
+    void queueSpawns(const std::vector<SpawnGroup>& groups, int delayMs);
+
+    inline void seed(unsigned int s) { wave_generator.seed(s); }
+    inline void setWave(int w) { wave = w; }
+    inline void setScore(int s) { score = s; }
+    inline void updateScore(int v) { score += v; }
+
+    inline Outcome getOutcome() const { return outcome; }
+    inline qint64 getTick() const { return simTick; }
+    inline int getWave() const { return wave; }
+    inline int getScore() const { return score; }
+    inline int getEnemyCount() const { return enemyCount; }
+    inline QPointF getSpawnPoint() const { return navPath[0]; }
+    inline TileGrid& getTiles() { return tiles; }
+    inline TowerUpgrades& getUpgrades() { return upgrades; }
+    inline const TowerUpgrades& getUpgrades() const { return upgrades; }
+    inline StatusEffects& getEffects() { return effects; }
+    inline const StatusEffects& getEffects() const { return effects; }
+    inline const std::vector<Enemy*>& getEnemies() const { return enemies; }
+    inline const std::vector<Tower*>& getTowers() const { return towers; }
+    inline const ProjectilePool& getProjectiles() const { return projectiles; }
+    inline const SpawnStream& getSpawns() const { return spawns; }
+    inline const std::vector<DamageHit>& getHits() const { return hits; }
+private:
+    qint64 simTick;
+    int wave;
+    int score;
+    int enemyCount;   //enemies of the wave still alive or to come
+    int stress;       //wave size a stress run refills to, 0 in a normal game
+    Outcome outcome;
+
+    QPointF navPath[CONSTANTS::PATH_TILE_COUNT];
+    TileGrid tiles;
+    WaveGenerator wave_generator;
+    SpawnStream spawns;
+
+    std::vector<Enemy*> enemies;
+    std::vector<Tower*> towers;
+    TowerUpgrades upgrades;
+    ProjectilePool projectiles;
+    StatusEffects effects;
+    EnemyGrid enemyGrid;
+    PathIndex pathIndex;
+    std::vector<Enemy*> victims;
+    std::vector<DamageHit> hits;
+
+    void spawner();
+    void moveEnemies();
+    void raycast();
+    void cover(Tower* t);
+    Enemy* selectTarget(Tower* t, float ready, float& when);
+    Enemy* targetAt(Tower* t, float when);
+    bool outranks(Targeting targeting, Enemy* a, Enemy* b, QPoint center, float when) const;
+    void updateProjectiles();
+    void hitEnemy(Enemy* e, int damage);
+    void enemyGone();
+    void applyEffect(Enemy* e, int towerType);
+    void applyBurns(const std::vector<EffectHit>& burns);
+    void cleanEnemyList();
+    void removeEnemies();
+};
+
+#endif // SIMULATION_H
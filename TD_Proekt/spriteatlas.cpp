@@ -0,0 +1,101 @@
+#include "spriteatlas.h"
+#include "memorystats.h"
+
+#include <QPainter>
+#include <algorithm>
+
+using namespace ATLAS;
+
+bool SpriteAtlas::find(const SpriteKey& key, Slot& slot){
+    auto found = entries.find(key);
+    if(found == entries.end())
+        return false;
+    slot = found->second;
+    pages[slot.page].lastUsed = frame;
+    return true;
+}
+
+SpriteAtlas::Slot SpriteAtlas::insert(const SpriteKey& key, const QImage& sprite){
+    Slot slot;
+    slot.page = -1;
+    for(size_t i = 0; i < pages.size() && slot.page < 0; i++)
+        if(pack(pages[i], sprite.size(), slot.source))
+            slot.page = i;
+
+    if(slot.page < 0){
+        //Pages already handed out this frame must stay valid until the batch is flushed, so an over-full
+        //atlas keeps growing and is only rebuilt in endFrame
+        pages.push_back(Page(std::max(PAGE_SIZE, sprite.width()+PADDING), std::max(PAGE_SIZE, sprite.height()+PADDING)));
+        pack(pages.back(), sprite.size(), slot.source);
+        slot.page = pages.size()-1;
+        MemoryStats::track(MemoryStats::ATLAS, 1, qint64(pages.back().pixmap.width())*pages.back().pixmap.height()*4);
+        if(pages.size() > (size_t)MAX_PAGES)
+            overflowed = true;
+    }
+
+    QPainter painter(&pages[slot.page].pixmap);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.drawImage(slot.source.topLeft(), sprite);
+    painter.end();
+
+    pages[slot.page].lastUsed = frame;
+    entries[key] = slot;
+    return slot;
+}
+
+void SpriteAtlas::endFrame(){
+    frame++;
+    if(overflowed){
+        clear();
+        return;
+    }
+    if(frame % EVICT_FRAMES != 0)
+        return;
+
+    std::vector<bool> stale(pages.size());
+    bool any = false;
+    for(size_t i = 0; i < pages.size(); i++){
+        stale[i] = pages[i].lastUsed < frame - EVICT_FRAMES;
+        any = any || stale[i];
+    }
+    if(!any)
+        return;
+
+    for(auto s = entries.begin(); s != entries.end();)
+        stale[s->second.page] ? s = entries.erase(s) : ++s;
+    for(size_t i = 0; i < pages.size(); i++){
+        if(stale[i]){
+            pages[i].shelfX = pages[i].shelfY = pages[i].shelfHeight = 0;
+            pages[i].lastUsed = frame;
+        }
+    }
+}
+
+void SpriteAtlas::clear(){
+    for(const auto& p : pages)
+        MemoryStats::track(MemoryStats::ATLAS, -1, -qint64(p.pixmap.width())*p.pixmap.height()*4);
+    pages.clear();
+    entries.clear();
+    overflowed = false;
+}
+
+bool SpriteAtlas::pack(Page& page, QSize size, QRect& out){
+    int w = size.width() + PADDING;
+    int h = size.height() + PADDING;
+    int x = page.shelfX;
+    int y = page.shelfY;
+    int shelf = page.shelfHeight;
+    if(x + w > page.pixmap.width()){
+        x = 0;
+        y += shelf;
+        shelf = 0;
+    }
+    if(x + w > page.pixmap.width() || y + h > page.pixmap.height())
+        return false;
+
+    out = QRect(x, y, size.width(), size.height());
+    page.shelfX = x + w;
+    page.shelfY = y;
+    page.shelfHeight = std::max(shelf, h);
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef SPRITEATLAS_H
+#define SPRITEATLAS_H
+
+#include <QImage>
+#include <QPixmap>
+#include <QRect>
+#include <QSize>
+#include <map>
+#include <tuple>
+#include <vector>
+
+
+namespace ATLAS{
+    const int PAGE_SIZE = 1024;
+    const int PADDING = 1;
+    const int MAX_PAGES = 8;      //past this the atlas is rebuilt from scratch at the end of the frame
+    const int EVICT_FRAMES = 120; //pages nothing was drawn from for this many frames are recycled
+}
+
+//Which pixels of which image, at which device size
+class SpriteKey
+{
+public:
+    SpriteKey(qint64 image, const QRect& source, QSize device) : image(image), source(source), device(device) {}
+
+    bool operator<(const SpriteKey& o) const{
+        return std::make_tuple(image, source.x(), source.y(), source.width(), source.height(), device.width(), device.height()) <
+               std::make_tuple(o.image, o.source.x(), o.source.y(), o.source.width(), o.source.height(), o.device.width(), o.device.height());
+    }
+private:
+    qint64 image;
+    QRect source;
+    QSize device;
+};
+
+//Device-resolution sprites packed into a few large pixmaps, so sprites that share a page can be submitted
+//together. Pages are filled shelf by shelf and recycled whole once nothing on them is drawn any more.
+class SpriteAtlas
+{
+public:
+    SpriteAtlas() : frame(0), overflowed(false) {}
+
+    class Slot{
+    public:
+        int page;
+        QRect source;
+    };
+
+    bool find(const SpriteKey& key, Slot& slot);
+    Slot insert(const SpriteKey& key, const QImage& sprite);
+    void endFrame();
+    void clear();
+
+    inline const QPixmap& getPage(int i) const { return pages[i].pixmap; }
+    inline int getPageCount() const { return pages.size(); }
+private:
+    class Page{
+    public:
+        Page(int w, int h) : pixmap(w, h), shelfX(0), shelfY(0), shelfHeight(0), lastUsed(0) { pixmap.fill(Qt::transparent); }
+        QPixmap pixmap;
+        int shelfX, shelfY, shelfHeight;
+        qint64 lastUsed;
+    };
+
+    std::vector<Page> pages;
+    std::map<SpriteKey, Slot> entries;
+    qint64 frame;
+    bool overflowed;
+
+    static bool pack(Page& page, QSize size, QRect& out);
+};
+
+#endif // SPRITEATLAS_H
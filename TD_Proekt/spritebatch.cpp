@@ -0,0 +1,36 @@
+#include "spritebatch.h"
+
+#include <algorithm>
+
+static const int PAGE_BITS = 16;
+
+void SpriteBatch::add(Layer layer, int page, QPoint at, const QRect& source, bool mirrored){
+    //Fragments are placed and flipped around their centre
+    QPointF center(at.x() + source.width()/2.0, at.y() + source.height()/2.0);
+    commands.push_back(Command((layer << PAGE_BITS) | page, queued.size()));
+    queued.push_back(QPainter::PixmapFragment::create(center, QRectF(source), mirrored ? -1 : 1));
+}
+
+void SpriteBatch::flush(QPainter& p, const SpriteAtlas& atlas){
+    //Stable so sprites of one group keep the order they were drawn in
+    std::stable_sort(commands.begin(), commands.end());
+
+    fragments.clear();
+    for(const auto& c : commands)
+        fragments.push_back(queued[c.index]);
+
+    drawCalls = 0;
+    size_t start = 0;
+    while(start < commands.size()){
+        size_t end = start + 1;
+        while(end < commands.size() && commands[end].key == commands[start].key)
+            end++;
+        int page = commands[start].key & ((1 << PAGE_BITS) - 1);
+        p.drawPixmapFragments(fragments.data() + start, end - start, atlas.getPage(page));
+        drawCalls++;
+        start = end;
+    }
+
+    commands.clear();
+    queued.clear();
+}
@@ -0,0 +1,41 @@
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+#include "spriteatlas.h"
+#include <QPainter>
+#include <QPoint>
+#include <QRect>
+#include <vector>
+
+
+//Paint order between groups, sprites inside one layer must not depend on each other's order
+enum Layer {LAYER_GROUND, LAYER_GROUND_TOP, LAYER_UNITS, LAYER_EFFECTS, LAYER_HUD, LAYER_HUD_TOP, LAYER_TOOLTIP, LAYER_TOOLTIP_TOP};
+
+//Collects a frame's sprite draws and submits them grouped by layer and atlas page,
+//one drawPixmapFragments call per group
+class SpriteBatch
+{
+public:
+    SpriteBatch() : drawCalls(0) {}
+
+    void add(Layer layer, int page, QPoint at, const QRect& source, bool mirrored=false);
+    void flush(QPainter& p, const SpriteAtlas& atlas);
+
+    inline int getDrawCalls() const { return drawCalls; }
+    inline int getSpriteCount() const { return fragments.size(); }
+private:
+    class Command{
+    public:
+        Command(int k, int i) : key(k), index(i) {}
+        bool operator<(const Command& o) const { return key < o.key; }
+        int key;    //layer and page, compared as one number
+        int index;  //into queued
+    };
+
+    std::vector<Command> commands;
+    std::vector<QPainter::PixmapFragment> queued;
+    std::vector<QPainter::PixmapFragment> fragments;
+    int drawCalls;
+};
+
+#endif // SPRITEBATCH_H
@@ -0,0 +1,19 @@
+#include "spritesheet.h"
+#include "assets.h"
+
+#include <algorithm>
+
+bool SpriteSheet::load(QString filePath, int frameCount, int ms, bool right){
+    image = Assets::image(filePath);
+    frames.clear();
+    if(image.isNull())
+        return false;
+
+    int count = std::max(1, std::min(frameCount, image.width()));
+    int w = image.width()/count;
+    for(int f = 0; f < count; f++)
+        frames.push_back(QRect(f*w, 0, w, image.height()));
+    frameMs = std::max(1, ms);
+    facesRight = right;
+    return true;
+}
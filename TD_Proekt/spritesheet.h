@@ -0,0 +1,38 @@
+#ifndef SPRITESHEET_H
+#define SPRITESHEET_H
+
+#include <QImage>
+#include <QRect>
+#include <QSize>
+#include <QString>
+#include <vector>
+
+
+namespace ANIMATION{
+    const int DEFAULT_FRAME_MS = 150;
+}
+
+//Equal sized frames laid out left to right in one image. A sheet is drawn in the direction it faces
+//and mirrored at draw time for the other one, and is shared by every entity that plays it; entities
+//only keep their own frame index and timer.
+class SpriteSheet
+{
+public:
+    SpriteSheet() : frameMs(ANIMATION::DEFAULT_FRAME_MS), facesRight(false) {}
+
+    bool load(QString filePath, int frameCount, int ms, bool right);
+
+    inline const QImage& getImage() const { return image; }
+    inline const QRect& getFrame(int f) const { return frames[f]; }
+    inline int getFrameCount() const { return frames.size(); }
+    inline QSize getFrameSize() const { return frames.empty() ? QSize() : frames[0].size(); }
+    inline int getFrameMs() const { return frameMs; }
+    inline bool isMirrored(bool faceRight) const { return faceRight != facesRight; }
+private:
+    QImage image;
+    std::vector<QRect> frames;
+    int frameMs;
+    bool facesRight;  //direction the frames are drawn in
+};
+
+#endif // SPRITESHEET_H
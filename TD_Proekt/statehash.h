@@ -0,0 +1,38 @@
+#ifndef STATEHASH_H
+#define STATEHASH_H
+
+#include <QString>
+#include <QtGlobal>
+#include <cstring>
+
+
+namespace STATEHASH{
+    const QString ARGUMENT = "--hash-log";
+    const quint64 OFFSET = 0xcbf29ce484222325ULL;
+    const quint64 PRIME = 0x100000001b3ULL;
+}
+
+//FNV style hash taken a 64 bit word at a time, so hashing every enemy each tick stays cheap.
+//Only meant to tell two simulations apart, not to resist anyone.
+class StateHash
+{
+public:
+    StateHash(quint64 seed = STATEHASH::OFFSET) : h(seed) {}
+
+    inline void add(quint64 v){
+        h ^= v;
+        h *= STATEHASH::PRIME;
+        h ^= h >> 29;
+    }
+    inline void add(qint64 v) { add(quint64(v)); }
+    inline void add(int v) { add(quint64(qint64(v))); }
+    inline void add(bool v) { add(quint64(v)); }
+    inline void add(float v) { quint32 bits; std::memcpy(&bits, &v, sizeof(bits)); add(quint64(bits)); }
+    inline void add(double v) { quint64 bits; std::memcpy(&bits, &v, sizeof(bits)); add(bits); }
+
+    inline quint64 get() const { return h; }
+private:
+    quint64 h;
+};
+
+#endif // STATEHASH_H
@@ -0,0 +1,91 @@
+#include "statuseffects.h"
+
+StatusEffects::StatusEffects(){
+    for(auto& p : pools){
+        p.target.reserve(STATUS::RESERVE);
+        p.magnitude.reserve(STATUS::RESERVE);
+        p.expiry.reserve(STATUS::RESERVE);
+    }
+}
+
+void StatusEffects::apply(Effect e, Enemy* target, float magnitude, qint64 expiry){
+    if(e == EFFECT_NONE)
+        return;
+    pools[e].target.push_back(target);
+    pools[e].magnitude.push_back(magnitude);
+    pools[e].expiry.push_back(expiry);
+}
+
+void StatusEffects::Pool::retire(size_t i){
+    target[i] = target.back();
+    magnitude[i] = magnitude.back();
+    expiry[i] = expiry.back();
+    target.pop_back();
+    magnitude.pop_back();
+    expiry.pop_back();
+}
+
+//Expires what ran out and hands the rest to their enemies: slows and stuns lower the speed factor the
+//next move uses, burns are returned as hits for the caller to apply. The list stays valid until the next call.
+const std::vector<EffectHit>& StatusEffects::update(qint64 tick, bool burnTick){
+    burns.clear();
+    for(int e = 0; e < EFFECT_COUNT; e++){
+        Pool& p = pools[e];
+        size_t i = 0;
+        while(i < p.target.size()){
+            Enemy* t = p.target[i];
+            if(p.expiry[i] <= tick || t->isDead()){
+                p.retire(i);
+                continue;
+            }
+            switch(e){
+                case EFFECT_SLOW:
+                    t->slowTo(p.magnitude[i]);
+                    break;
+                case EFFECT_STUN:
+                    t->slowTo(0);
+                    break;
+                case EFFECT_BURN:
+                    if(burnTick)
+                        burns.push_back(EffectHit(t, qRound(p.magnitude[i])));
+                    break;
+            }
+            i++;
+        }
+    }
+    return burns;
+}
+
+//Has to run before dead enemies are deleted, like ProjectilePool::dropDeadTargets
+void StatusEffects::dropDeadTargets(){
+    for(auto& p : pools){
+        size_t i = 0;
+        while(i < p.target.size()){
+            if(p.target[i]->isDead())
+                p.retire(i);
+            else
+                i++;
+        }
+    }
+    burns.clear();
+}
+
+void StatusEffects::clear(){
+    for(auto& p : pools){
+        p.target.clear();
+        p.magnitude.clear();
+        p.expiry.clear();
+    }
+    burns.clear();
+}
+
+//Order, strength and expiry of every effect. Targets are left to the enemies' own hash, their addresses differ between runs.
+void StatusEffects::hash(StateHash& h) const{
+    for(const auto& p : pools){
+        h.add(int(p.target.size()));
+        for(size_t i = 0; i < p.target.size(); i++){
+            h.add(p.magnitude[i]);
+            h.add(p.expiry[i]);
+        }
+    }
+}
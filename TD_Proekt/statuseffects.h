@@ -0,0 +1,59 @@
+#ifndef STATUSEFFECTS_H
+#define STATUSEFFECTS_H
+
+#include "enemy.h"
+#include "statehash.h"
+#include <QtGlobal>
+#include <vector>
+
+
+namespace STATUS{
+    const int RESERVE = 16384;        //per effect type, the arrays only grow past this under heavy load
+    const int BURN_PERIOD_MS = 500;   //burns deal their damage once per period
+}
+
+//NONE is what towers without an on-hit effect use
+enum Effect {EFFECT_SLOW, EFFECT_BURN, EFFECT_STUN, EFFECT_COUNT, EFFECT_NONE = EFFECT_COUNT};
+
+class EffectHit
+{
+public:
+    EffectHit(Enemy* e, int d) : target(e), damage(d) {}
+
+    Enemy* target;
+    int damage;
+};
+
+//Every active slow, burn and stun, stored as parallel arrays per effect type and packed like the
+//projectile pool: an expired entry is replaced by the last one. Effects on one enemy don't merge,
+//overlapping slows keep the strongest and overlapping burns add up.
+class StatusEffects
+{
+public:
+    StatusEffects();
+
+    void apply(Effect e, Enemy* target, float magnitude, qint64 expiry);
+    const std::vector<EffectHit>& update(qint64 tick, bool burnTick);
+    void dropDeadTargets();
+    void clear();
+    void hash(StateHash& h) const;
+
+    inline int size(Effect e) const { return pools[e].target.size(); }
+    inline Enemy* getTarget(Effect e, int i) const { return pools[e].target[i]; }
+    inline float getMagnitude(Effect e, int i) const { return pools[e].magnitude[i]; }
+    inline qint64 getExpiry(Effect e, int i) const { return pools[e].expiry[i]; }
+private:
+    class Pool{
+    public:
+        std::vector<Enemy*> target;
+        std::vector<float> magnitude;  //SLOW: speed multiplier, BURN: damage per burn tick, STUN: unused
+        std::vector<qint64> expiry;    //first tick the effect is gone
+
+        void retire(size_t i);
+    };
+
+    Pool pools[EFFECT_COUNT];
+    std::vector<EffectHit> burns;
+};
+
+#endif // STATUSEFFECTS_H
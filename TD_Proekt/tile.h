@@ -4,22 +4,14 @@
 #include "gameobject.h"
 
 
+//Only the picture of a map square, placement state lives in the game's TileGrid
 class Tile : public GameObject
 {
 public:
-    Tile(QString fileName, int id=0) : GameObject(fileName) , occupied(false) , active(false) , path_id(id){ (path_id==0) ? path = false : path = true; }
-    bool isActive() const { return active; }
-    bool isOccupied() const { return occupied; }
-    bool isPath() const { return path; }
+    Tile(QString fileName, int id=0) : GameObject(fileName) , path_id(id){}
     int getPathID() const { return path_id; }
-
-    void setActive(bool b) { active = b; }
-    void setOccupied(bool b)  { occupied = b; }
 private:
-    bool path;
-    bool occupied;
-    bool active;
-    int path_id;
+    int path_id;  //position along the navigation path counting from 1, 0 off the path
 };
 
 #endif // TILE_H
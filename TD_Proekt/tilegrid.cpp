@@ -0,0 +1,57 @@
+#include "tilegrid.h"
+#include <QtAlgorithms>
+#include <algorithm>
+
+
+TileGrid::TileGrid(QPoint origin, int tileSize, int cols, int rows) : origin(origin), tileSize(tileSize),
+    cols(cols), rows(rows), buildable((cols*rows + 63)/64, 0), occupied(buildable.size(), 0), path(buildable.size(), 0)
+{
+    for(int i = 0; i < cols*rows; i++)
+        set(buildable, i, true);
+}
+
+int TileGrid::at(QPoint p) const{
+    int x = p.x() - origin.x();
+    int y = p.y() - origin.y();
+    if(x < 0 || y < 0 || x >= cols*tileSize || y >= rows*tileSize)
+        return -1;
+    return (y/tileSize)*cols + x/tileSize;
+}
+
+QRect TileGrid::rectOf(int tile) const{
+    return QRect(origin.x() + (tile%cols)*tileSize, origin.y() + (tile/cols)*tileSize, tileSize, tileSize);
+}
+
+int TileGrid::nextBuildable(int from) const{
+    if(from < 0 || from >= size())
+        return -1;
+    size_t w = from/64;
+    quint64 free = buildable[w] & ~occupied[w] & (~quint64(0) << (from%64));
+    while(free == 0){
+        if(++w == buildable.size())
+            return -1;
+        free = buildable[w] & ~occupied[w];
+    }
+    return w*64 + qCountTrailingZeroBits(free);
+}
+
+//Path tiles can never take a tower
+void TileGrid::setPath(int tile, bool b){
+    set(path, tile, b);
+    set(buildable, tile, !b);
+}
+
+void TileGrid::setOccupied(int tile, bool b){
+    set(occupied, tile, b);
+}
+
+void TileGrid::clearOccupied(){
+    std::fill(occupied.begin(), occupied.end(), 0);
+}
+
+void TileGrid::set(std::vector<quint64>& bits, int i, bool b){
+    if(b)
+        bits[i/64] |= quint64(1) << (i%64);
+    else
+        bits[i/64] &= ~(quint64(1) << (i%64));
+}
@@ -0,0 +1,45 @@
+#ifndef TILEGRID_H
+#define TILEGRID_H
+
+#include "gameobject.h"
+#include <QPoint>
+#include <QRect>
+#include <QtGlobal>
+#include <vector>
+
+
+//Placement state of the map, one bit per tile in row-major order packed into 64-bit words.
+//The tile under a point is found arithmetically from the grid origin and tile size, and whole-map
+//questions such as "where can still be built" are answered a word at a time.
+class TileGrid
+{
+public:
+    TileGrid(QPoint origin = QPoint(CONSTANTS::MAP_X, CONSTANTS::MAP_Y), int tileSize = CONSTANTS::TILE_SIZE,
+             int cols = CONSTANTS::TILE_COL, int rows = CONSTANTS::TILE_ROW);
+
+    int at(QPoint p) const;  //index of the tile containing p, -1 outside the map
+    QRect rectOf(int tile) const;
+    int nextBuildable(int from) const;  //first buildable tile at or after from, -1 if none
+
+    void setPath(int tile, bool b);
+    void setOccupied(int tile, bool b);
+    void clearOccupied();
+
+    inline bool isPath(int tile) const { return test(path, tile); }
+    inline bool isOccupied(int tile) const { return test(occupied, tile); }
+    inline bool canBuild(int tile) const { return test(buildable, tile) && !test(occupied, tile); }
+    inline int size() const { return cols*rows; }
+private:
+    QPoint origin;
+    int tileSize;
+    int cols, rows;
+
+    std::vector<quint64> buildable;
+    std::vector<quint64> occupied;
+    std::vector<quint64> path;
+
+    inline static bool test(const std::vector<quint64>& bits, int i) { return (bits[i/64] >> (i%64)) & 1; }
+    static void set(std::vector<quint64>& bits, int i, bool b);
+};
+
+#endif // TILEGRID_H
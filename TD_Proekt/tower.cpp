@@ -3,184 +3,100 @@
 #include <QRect>
 #include <QApplication>
 
-Tower::TowerStats Tower::fire = Tower::TowerStats();
-Tower::TowerStats Tower::ice = Tower::TowerStats();
-Tower::TowerStats Tower::earth = Tower::TowerStats();
-int Tower::fireCount = 0;
-int Tower::iceCount = 0;
-int Tower::earthCount = 0;
-
-Tower::Tower(QString fileName, QRect tile) : GameObject(fileName) , coolDown(false){
-    if(fileName == TOWER::TOWER_FIRE){
-        type = FIRE;
-        fireCount++;
-    }
-    else if(fileName == TOWER::TOWER_ICE){
-        type = ICE;
-        iceCount++;
-    }
-    else if(fileName == TOWER::TOWER_EARTH){
-        type = EARTH;
-        earthCount++;
-    }
-
+//Placing a tower doesn't touch the build counters, buying one goes through TowerUpgrades::countBuilt
+Tower::Tower(Type t, QRect tile) : GameObject(TowerTable::get(t).sprite) , type(t) , targeting(Targeting::FIRST) , readyTime(0){
     getRect()->moveTo(tile.topLeft()); //Move the tower to the tile location
 }
 
-void Tower::resetUpgrades(){
-    fireCount = 0;
-    iceCount = 0;
-    earthCount = 0;
-
-    fire.d_count = 0;
-    fire.r_count = 0;
-    fire.s_count = 0;
-
-    ice.d_count = 0;
-    ice.r_count = 0;
-    ice.s_count = 0;
-
-    earth.d_count = 0;
-    earth.r_count = 0;
-    earth.s_count = 0;
-}
-
-int Tower::getDamage(Type t){
-    switch(t){
-        case FIRE:
-            return (1+fire.d_count);
+void Tower::cycleTargeting(){
+    switch(targeting){
+        case Targeting::FIRST:
+            targeting = Targeting::LAST;
+            break;
+        case Targeting::LAST:
+            targeting = Targeting::STRONGEST;
             break;
-        case ICE:
-            return (3+ice.d_count);
+        case Targeting::STRONGEST:
+            targeting = Targeting::CLOSEST;
             break;
-        case EARTH:
-            return (5+earth.d_count);
+        case Targeting::CLOSEST:
+            targeting = Targeting::FIRST;
             break;
     }
 }
 
-int Tower::getRange(Type t){
+std::string Tower::getTargetingName(Targeting t){
     switch(t){
-        case FIRE:
-            return (40+fire.r_count*10);
-            break;
-        case ICE:
-            return (40+ice.r_count*10);
-            break;
-        case EARTH:
-            return (60+earth.r_count*10);
-            break;
+        case Targeting::LAST:
+            return "last";
+        case Targeting::STRONGEST:
+            return "strong";
+        case Targeting::CLOSEST:
+            return "close";
+        default:
+            return "first";
     }
 }
 
-int Tower::getCoolDown(Type t){
-    switch(t){
-        case FIRE:
-            return (500-fire.s_count*10);
-            break;
-        case ICE:
-            return (1000-ice.s_count*10);
-            break;
-        case EARTH:
-            return (2500-earth.s_count*10);
-            break;
-    }
+void TowerUpgrades::refresh(Type t){
+    const TowerArchetype& a = TowerTable::get(t);
+    EffectiveStats& e = effective[t];
+    e.damage = a.damage.at(stats[t].d_count);
+    e.range = a.range.at(stats[t].r_count);
+    e.rangeSq = e.range*e.range;
+    e.coolDown = a.coolDown.at(stats[t].s_count);
 }
 
-int Tower::getCost(Type t){
-    switch(t){
-        case FIRE:
-            return (10 + Tower::fireCount*5);
-            break;
-        case ICE:
-            return (15 + Tower::iceCount*5);
-            break;
-        case EARTH:
-            return (20 + Tower::earthCount*5);
-            break;
-    }
+//Sized to the tower table, so it has to run again after the table is reloaded
+void TowerUpgrades::reset(){
+    stats.assign(Tower::getTypeCount(), TowerStats());
+    effective.assign(Tower::getTypeCount(), EffectiveStats());
+    for(int t = 0; t < Tower::getTypeCount(); t++)
+        refresh(static_cast<Type>(t));
 }
 
-int Tower::getDamageCost(Type t){
-    switch(t){
-        case FIRE:
-            return (25 + Tower::fireCount*5 + fire.d_count*10);
-            break;
-        case ICE:
-            return (25 + Tower::iceCount*5 + ice.d_count*10);
-            break;
-        case EARTH:
-            return (25 + Tower::earthCount*5 + earth.d_count*10);
-            break;
-    }
+void TowerUpgrades::getCounts(Type t, int& d, int& r, int& s, int& count) const{
+    d = stats[t].d_count;
+    r = stats[t].r_count;
+    s = stats[t].s_count;
+    count = stats[t].built;
 }
 
-int Tower::getRangeCost(Type t){
-    switch(t){
-        case FIRE:
-            return (10 + Tower::fireCount*5 + fire.r_count*10);
-            break;
-        case ICE:
-            return (10 + Tower::iceCount*5 + ice.r_count*10);
-            break;
-        case EARTH:
-            return (10 + Tower::earthCount*5 + earth.r_count*10);
-            break;
-    }
+void TowerUpgrades::setCounts(Type t, int d, int r, int s, int count){
+    stats[t].d_count = d;
+    stats[t].r_count = r;
+    stats[t].s_count = s;
+    stats[t].built = count;
+    refresh(t);
 }
 
-int Tower::getCoolDownCost(Type t){
-    switch(t){
-        case FIRE:
-            return (50 + Tower::fireCount*5 + fire.d_count*5);
-            break;
-        case ICE:
-            return (50 + Tower::iceCount*5 + ice.d_count*5);
-            break;
-        case EARTH:
-            return (50 + Tower::earthCount*5 + earth.d_count*5);
-            break;
-    }
+int TowerUpgrades::getCost(Type t) const{
+    return TowerTable::get(t).cost.at(stats[t].built, 0);
 }
 
-void Tower::upgradeDamage(Type t){
-    switch(t){
-        case FIRE:
-            fire.d_count++;
-            break;
-        case ICE:
-            ice.d_count++;
-            break;
-        case EARTH:
-            earth.d_count++;
-            break;
-    }
+int TowerUpgrades::getDamageCost(Type t) const{
+    return TowerTable::get(t).damageCost.at(stats[t].built, stats[t].d_count);
 }
 
-void Tower::upgradeRange(Type t){
-    switch(t){
-        case FIRE:
-            fire.r_count++;
-            break;
-        case ICE:
-            ice.r_count++;
-            break;
-        case EARTH:
-            earth.r_count++;
-            break;
-    }
+int TowerUpgrades::getRangeCost(Type t) const{
+    return TowerTable::get(t).rangeCost.at(stats[t].built, stats[t].r_count);
 }
 
-void Tower::upgradeCoolDown(Type t){
-    switch(t){
-        case FIRE:
-            fire.s_count++;
-            break;
-        case ICE:
-            ice.s_count++;
-            break;
-        case EARTH:
-            earth.s_count++;
-            break;
-    }
+int TowerUpgrades::getCoolDownCost(Type t) const{
+    return TowerTable::get(t).coolDownCost.at(stats[t].built, stats[t].s_count);
+}
+
+void TowerUpgrades::upgradeDamage(Type t){
+    stats[t].d_count++;
+    refresh(t);
+}
+
+void TowerUpgrades::upgradeRange(Type t){
+    stats[t].r_count++;
+    refresh(t);
+}
+
+void TowerUpgrades::upgradeCoolDown(Type t){
+    stats[t].s_count++;
+    refresh(t);
 }
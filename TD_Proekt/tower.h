@@ -3,64 +3,87 @@
 
 #include "gameobject.h"
 #include <QPointF>
+#include <QtGlobal>
 #include "image.h"
 #include "enemy.h"
+#include "towertable.h"
+#include "pathindex.h"
+#include <vector>
+#include <string>
 
 
-namespace TOWER{
-    const QString TOWER_FIRE = ":/fire.png";
-    const QString TOWER_ICE = ":/ice.png";
-    const QString TOWER_EARTH = ":/rock.png";
-}
+//Index into TowerTable, the named values are the rows of the default table
+enum Type : int {FIRE,ICE,EARTH};
 
-enum Type{FIRE,ICE,EARTH};
+enum class Targeting{FIRST, LAST, STRONGEST, CLOSEST};
 
 
 class Tower : public GameObject
 {
     Q_OBJECT
 public:
-    Tower(QString fileName, QRect tile);
+    Tower(Type t, QRect tile);
 
-    inline int getTimer() const { return timerID; }
-    inline bool isCoolDown() const { return coolDown; }
+    inline bool isCoolDown(qint64 tick) const { return tick < readyTime; }
+    inline double getReadyTime() const { return readyTime; }
     inline Type getType() const { return type; }
+    inline Targeting getTargeting() const { return targeting; }
+    inline void setTargeting(Targeting t) { targeting = t; }
+    void cycleTargeting();
+    static std::string getTargetingName(Targeting t);
 
-    inline void setTimer(int id) { timerID = id; }
-    inline void setCoolDown(bool c) { coolDown = c; }
-
-    static int getCost(Type t);
-    static int getDamageCost(Type t);
-    static int getRangeCost(Type t);
-    static int getCoolDownCost(Type t);
-    static int getDamage(Type t);
-    static int getRange(Type t);
-    static int getCoolDown(Type t);
-    static void upgradeDamage(Type t);
-    static void upgradeRange(Type t);
-    static void upgradeCoolDown(Type t);
-
-    static void resetUpgrades();
-public slots:
-    void toggleCoolDown(){setCoolDown(false);}
+    inline void setReadyTime(double time) { readyTime = time; }
+    inline const Coverage& getCoverage() const { return coverage; }
+    inline void setCoverage(const Coverage& c) { coverage = c; }
+
+    inline static int getTypeCount() { return TowerTable::size(); }
 private:
     Type type;
-    int timerID;
-    bool coolDown;
+    Targeting targeting;
+    double readyTime;  //simulation time in ticks from which the tower may fire again, shots land between ticks
+    Coverage coverage;
+};
+
+//Upgrade levels and build counts per tower type. They apply to every tower of a type, so each Simulation
+//owns a set rather than the towers, and games running side by side can upgrade independently.
+class TowerUpgrades
+{
+public:
+    void reset();
 
+    int getCost(Type t) const;
+    int getDamageCost(Type t) const;
+    int getRangeCost(Type t) const;
+    int getCoolDownCost(Type t) const;
+    inline int getDamage(Type t) const { return effective[t].damage; }
+    inline int getRange(Type t) const { return effective[t].range; }
+    inline int getRangeSq(Type t) const { return effective[t].rangeSq; }
+    inline int getCoolDown(Type t) const { return effective[t].coolDown; }
+    void upgradeDamage(Type t);
+    void upgradeRange(Type t);
+    void upgradeCoolDown(Type t);
+
+    inline void countBuilt(Type t) { stats[t].built++; }
+    void getCounts(Type t, int& d, int& r, int& s, int& count) const;
+    void setCounts(Type t, int d, int r, int s, int count);
+private:
     class TowerStats{
     public:
-        TowerStats():d_count(0), r_count(0), s_count(0){}
-        int d_count, r_count, s_count;
+        TowerStats():d_count(0), r_count(0), s_count(0), built(0){}
+        int d_count, r_count, s_count, built;
+    };
+
+    //Values the game loop asks for on every tower-enemy check, rebuilt only when an upgrade changes them
+    class EffectiveStats{
+    public:
+        EffectiveStats():damage(0), range(0), rangeSq(0), coolDown(0){}
+        int damage, range, rangeSq, coolDown;
     };
 
-    static TowerStats fire;
-    static TowerStats ice;
-    static TowerStats earth;
+    std::vector<TowerStats> stats;
+    std::vector<EffectiveStats> effective;
 
-    static int fireCount;
-    static int iceCount;
-    static int earthCount;
+    void refresh(Type t);
 };
 
 #endif // TOWER_H
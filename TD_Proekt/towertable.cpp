@@ -0,0 +1,84 @@
+#include "towertable.h"
+#include "config.h"
+#include "assets.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+std::vector<TowerArchetype> TowerTable::archetypes;
+
+int StatCurve::at(int upgrades) const{
+    return std::min(max, std::max(min, base + perUpgrade*upgrades));
+}
+
+static StatCurve readStat(const ConfigSection& s, QString key){
+    return StatCurve(s.getInt(key),
+                     s.getInt(key + "_per_upgrade"),
+                     s.getInt(key + "_min", 0),
+                     s.getInt(key + "_max", 1000000));
+}
+
+static CostCurve readCost(const ConfigSection& s, QString key){
+    return CostCurve(s.getInt(key),
+                     s.getInt(key + "_per_tower"),
+                     s.getInt(key + "_per_upgrade"));
+}
+
+bool TowerTable::load(QString filePath){
+    Config config;
+    if(!config.load(filePath))
+        return false;
+
+    QStringList sprites;
+    for(const auto& s : config.getSections()){
+        sprites.append(s.getString("sprite"));
+        sprites.append(s.getString("upgrade_icon"));
+        sprites.append(s.getString("projectile"));
+    }
+    Assets::prefetch(sprites);
+
+    std::vector<TowerArchetype> table;
+    for(const auto& s : config.getSections()){
+        if(!s.contains("sprite"))
+            continue;
+
+        TowerArchetype a;
+        a.name = s.getName();
+        a.sprite = s.getString("sprite");
+        a.upgradeIcon = s.getString("upgrade_icon", a.sprite);
+        a.projectileSprite = s.getString("projectile", a.upgradeIcon);
+        int size = s.getInt("projectile_size", 8);
+        a.projectile = Assets::image(a.projectileSprite).scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        a.projectileSpeed = std::max(1, s.getInt("projectile_speed", 4));
+        QString area = s.getString("area", "single").toLower();
+        a.area = area == "splash" ? Area_Type::SPLASH : area == "cone" ? Area_Type::CONE : Area_Type::SINGLE;
+        a.splashRadius = s.getInt("splash_radius", 24);
+        double coneAngle = std::max(1, std::min(180, s.getInt("cone_angle", 60)));
+        a.coneCos = std::cos(coneAngle/2 * M_PI/180);
+        QString effect = s.getString("effect", "none").toLower();
+        a.effect = effect == "slow" ? EFFECT_SLOW : effect == "burn" ? EFFECT_BURN : effect == "stun" ? EFFECT_STUN : EFFECT_NONE;
+        double strength = s.getDouble("effect_strength");
+        //Slows are configured as the percentage of speed taken away
+        a.effectStrength = a.effect == EFFECT_SLOW ? 1 - std::max(0.0, std::min(100.0, strength))/100 : strength;
+        //Burns deal whole hit points
+        if(a.effect == EFFECT_BURN && a.effectStrength != std::round(a.effectStrength)){
+            a.effectStrength = std::round(a.effectStrength);
+            qWarning() << "tower" << a.name << "burn effect_strength" << strength << "is not whole, using" << a.effectStrength;
+        }
+        a.effectMs = std::max(0, s.getInt("effect_ms"));
+        a.damage = readStat(s, "damage");
+        a.range = readStat(s, "range");
+        a.coolDown = readStat(s, "cooldown");
+        a.cost = readCost(s, "cost");
+        a.damageCost = readCost(s, "damage_cost");
+        a.rangeCost = readCost(s, "range_cost");
+        a.coolDownCost = readCost(s, "cooldown_cost");
+        table.push_back(a);
+    }
+    if(table.empty())
+        return false;
+
+    archetypes = table;
+    return true;
+}
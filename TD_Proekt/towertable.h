@@ -0,0 +1,75 @@
+#ifndef TOWERTABLE_H
+#define TOWERTABLE_H
+
+#include "statuseffects.h"
+#include <QImage>
+#include <QString>
+#include <vector>
+
+
+namespace TOWER{
+    const QString CONFIG_FILE = "towers.cfg";
+}
+
+enum class Area_Type{SINGLE, SPLASH, CONE};
+
+//value = base + perUpgrade*upgrades, clamped to [min, max]
+class StatCurve
+{
+public:
+    StatCurve(int b = 0, int u = 0, int lo = 0, int hi = 1000000) : base(b), perUpgrade(u), min(lo), max(hi) {}
+    int at(int upgrades) const;
+
+    int base, perUpgrade, min, max;
+};
+
+//cost = base + perTower*towers built of this type + perUpgrade*upgrades already bought
+class CostCurve
+{
+public:
+    CostCurve(int b = 0, int t = 0, int u = 0) : base(b), perTower(t), perUpgrade(u) {}
+    inline int at(int towers, int upgrades) const { return base + perTower*towers + perUpgrade*upgrades; }
+
+    int base, perTower, perUpgrade;
+};
+
+class TowerArchetype
+{
+public:
+    QString name;
+    QString sprite;
+    QString upgradeIcon;
+    QString projectileSprite;
+    QImage projectile;
+    int projectileSpeed;  //pixels per tick
+
+    Area_Type area;
+    int splashRadius;      //SPLASH: radius around the impact point
+    double coneCos;        //CONE: cosine of half the cone angle, the cone reaches as far as the range
+
+    Effect effect;         //applied to everything the tower hits
+    float effectStrength;  //SLOW: speed multiplier while slowed, BURN: damage per burn period
+    int effectMs;
+
+    StatCurve damage;
+    StatCurve range;
+    StatCurve coolDown;
+
+    CostCurve cost;
+    CostCurve damageCost;
+    CostCurve rangeCost;
+    CostCurve coolDownCost;
+};
+
+class TowerTable
+{
+public:
+    static bool load(QString filePath);
+
+    inline static int size() { return archetypes.size(); }
+    inline static const TowerArchetype& get(int t) { return archetypes[t]; }
+private:
+    static std::vector<TowerArchetype> archetypes;
+};
+
+#endif // TOWERTABLE_H
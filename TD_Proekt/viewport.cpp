@@ -0,0 +1,124 @@
+#include "viewport.h"
+#include "memorystats.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace VIEWPORT;
+
+Viewport::Viewport(int logicalWidth, int logicalHeight) : logicalSize(logicalWidth, logicalHeight),
+    zoom(1), dpr(1), deviceZoom(1), frame(0){}
+
+//Returns true when the zoom changed and the cached sprites were dropped
+bool Viewport::resize(QSize widgetSize, qreal devicePixelRatio){
+    qreal fit = std::min(widgetSize.width()/qreal(logicalSize.width()), widgetSize.height()/qreal(logicalSize.height()));
+    qreal snapped = std::max(MIN_ZOOM, std::floor(fit*devicePixelRatio/ZOOM_STEP)*ZOOM_STEP);
+
+    bool changed = snapped != deviceZoom || devicePixelRatio != dpr;
+    if(changed){
+        deviceZoom = snapped;
+        dpr = devicePixelRatio;
+        zoom = deviceZoom/dpr;
+        atlas.clear();
+    }
+
+    //Centre the playfield, on whole device pixels so blits stay unfiltered
+    qreal x = std::floor((widgetSize.width()*dpr - logicalSize.width()*deviceZoom)/2);
+    qreal y = std::floor((widgetSize.height()*dpr - logicalSize.height()*deviceZoom)/2);
+    origin = QPointF(std::max<qreal>(0, x)/dpr, std::max<qreal>(0, y)/dpr);
+    return changed;
+}
+
+QPoint Viewport::toLogical(QPoint widgetPos) const{
+    return QPoint(std::floor((widgetPos.x() - origin.x())/zoom), std::floor((widgetPos.y() - origin.y())/zoom));
+}
+
+//Smallest widget rect covering the logical one, for partial repaints
+QRect Viewport::toWidget(const QRect& logical) const{
+    return QRectF(origin.x() + logical.x()*zoom, origin.y() + logical.y()*zoom, logical.width()*zoom, logical.height()*zoom).toAlignedRect();
+}
+
+void Viewport::draw(Layer layer, const QRect& logical, const QImage& image){
+    queue(layer, logical.topLeft(), QSize(std::lround(logical.width()*deviceZoom), std::lround(logical.height()*deviceZoom)),
+          image, image.rect(), false);
+}
+
+void Viewport::draw(Layer layer, QPointF logicalTopLeft, const QImage& image){
+    queue(layer, logicalTopLeft, QSize(std::lround(image.width()*deviceZoom), std::lround(image.height()*deviceZoom)),
+          image, image.rect(), false);
+}
+
+//One frame of a sprite sheet. Only the unmirrored frame goes into the atlas, the batch flips it when drawing
+void Viewport::draw(Layer layer, const QRect& logical, const QImage& sheet, const QRect& source, bool mirrored){
+    queue(layer, logical.topLeft(), QSize(std::lround(logical.width()*deviceZoom), std::lround(logical.height()*deviceZoom)),
+          sheet, source, mirrored);
+}
+
+void Viewport::queue(Layer layer, QPointF logicalTopLeft, QSize deviceSize, const QImage& image, const QRect& source, bool mirrored){
+    if(image.isNull() || deviceSize.isEmpty())
+        return;
+
+    SpriteKey key(image.cacheKey(), source, deviceSize);
+    SpriteAtlas::Slot slot;
+    if(!atlas.find(key, slot))
+        slot = atlas.insert(key, scaleFrom(source == image.rect() ? image : image.copy(source), deviceSize));
+
+    QPoint at(std::lround(origin.x()*dpr + logicalTopLeft.x()*deviceZoom), std::lround(origin.y()*dpr + logicalTopLeft.y()*deviceZoom));
+    batch.add(layer, slot.page, at, slot.source, mirrored);
+}
+
+//Submits the frame in device pixels, so the atlas pages are sampled 1:1
+void Viewport::flush(QPainter& p){
+    p.save();
+    p.scale(1/dpr, 1/dpr);
+    batch.flush(p, atlas);
+    p.restore();
+
+    atlas.endFrame();
+    frame++;
+    if(frame % EVICT_FRAMES != 0)
+        return;
+    for(auto py = pyramids.begin(); py != pyramids.end();){
+        if(py->second.lastUsed >= frame - EVICT_FRAMES){
+            ++py;
+            continue;
+        }
+        //Level 0 shares the source's pixels, only the reductions are ours
+        for(size_t l = 1; l < py->second.levels.size(); l++)
+            MemoryStats::track(MemoryStats::SCALED, -1, -MemoryStats::bytes(py->second.levels[l]));
+        py = pyramids.erase(py);
+    }
+}
+
+QImage Viewport::scaleFrom(const QImage& image, QSize deviceSize){
+    if(deviceSize == image.size())
+        return image;
+
+    //Pixel art grows by whole multiples without blurring, only the fractional rest is filtered
+    if(deviceSize.width() >= image.width() && deviceSize.height() >= image.height()){
+        int n = std::min(deviceSize.width()/image.width(), deviceSize.height()/image.height());
+        QImage whole = image.scaled(image.width()*n, image.height()*n, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+        if(whole.size() == deviceSize)
+            return whole;
+        return whole.scaled(deviceSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+
+    //Shrinking filters from the smallest pyramid level that is still at least the target size,
+    //so a single smooth pass never has to cover more than a factor of two
+    Pyramid& pyramid = pyramids[image.cacheKey()];
+    pyramid.lastUsed = frame;
+    if(pyramid.levels.empty())
+        pyramid.levels.push_back(image);
+    while(pyramid.levels.back().width()/2 >= deviceSize.width() && pyramid.levels.back().height()/2 >= deviceSize.height()){
+        QImage half = pyramid.levels.back().scaled(pyramid.levels.back().width()/2, pyramid.levels.back().height()/2,
+                                                   Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        pyramid.levels.push_back(half);
+        MemoryStats::track(MemoryStats::SCALED, 1, MemoryStats::bytes(half));
+    }
+
+    size_t level = 0;
+    while(level+1 < pyramid.levels.size() && pyramid.levels[level+1].width() >= deviceSize.width() &&
+          pyramid.levels[level+1].height() >= deviceSize.height())
+        level++;
+    return pyramid.levels[level].scaled(deviceSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
@@ -0,0 +1,64 @@
+#ifndef VIEWPORT_H
+#define VIEWPORT_H
+
+#include "spriteatlas.h"
+#include "spritebatch.h"
+#include <QImage>
+#include <QPainter>
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include <QSize>
+#include <map>
+#include <vector>
+
+
+namespace VIEWPORT{
+    const double ZOOM_STEP = 0.25;   //device pixels per logical pixel snap to this, so resizing reuses cached sizes
+    const double MIN_ZOOM = 0.25;
+    const int EVICT_FRAMES = 120;    //pyramids unused for this many frames are dropped
+}
+
+//Maps the fixed logical playfield (CONSTANTS::SCREEN_WIDTH x SCREEN_HEIGHT) onto a widget of any size and
+//pixel density. Every sprite is scaled once per zoom level into a SpriteAtlas page, and draws are queued in
+//a SpriteBatch, so a frame is a few unscaled blits out of shared pixmaps.
+class Viewport
+{
+public:
+    Viewport(int logicalWidth, int logicalHeight);
+
+    bool resize(QSize widgetSize, qreal devicePixelRatio);
+    QPoint toLogical(QPoint widgetPos) const;
+    QRect toWidget(const QRect& logical) const;
+
+    void draw(Layer layer, const QRect& logical, const QImage& image);
+    void draw(Layer layer, QPointF logicalTopLeft, const QImage& image);
+    void draw(Layer layer, const QRect& logical, const QImage& sheet, const QRect& source, bool mirrored);
+    void flush(QPainter& p);
+
+    inline qreal getZoom() const { return zoom; }
+    inline int getDrawCalls() const { return batch.getDrawCalls(); }
+private:
+    QSize logicalSize;
+    qreal zoom;       //widget pixels per logical pixel
+    qreal dpr;
+    qreal deviceZoom; //device pixels per logical pixel, a multiple of ZOOM_STEP
+    QPointF origin;   //letterbox offset in widget pixels
+    qint64 frame;
+
+    //Halving chain of a source image, level 0 is the source itself
+    class Pyramid{
+    public:
+        std::vector<QImage> levels;
+        qint64 lastUsed;
+    };
+
+    SpriteAtlas atlas;
+    SpriteBatch batch;
+    std::map<qint64, Pyramid> pyramids;
+
+    void queue(Layer layer, QPointF logicalTopLeft, QSize deviceSize, const QImage& image, const QRect& source, bool mirrored);
+    QImage scaleFrom(const QImage& image, QSize deviceSize);
+};
+
+#endif // VIEWPORT_H
@@ -2,40 +2,106 @@
 #include <random>
 #include <chrono>
 #include <cmath>
+#include <algorithm>
 
-void WaveGenerator::clearSpawnList(){
-    spawnList.clear();
+static inline const WaveCurve& curve(int type){
+    return EnemyTable::get(type).wave;
 }
 
-std::vector<Enemy*> WaveGenerator::generateSpawnList(int wave, QPointF spawnLocation){
-    clearSpawnList();
+int WaveGenerator::getTokens(int wave){
+    return std::ceil(wave * WAVE::STEP_PER_WAVE) * WAVE::TOKENS_PER_STEP;
+}
 
-    int spawnTokens = std::ceil(wave * 0.2) * 10;
+void SpawnStream::start(const std::vector<SpawnGroup>& g, qint64 firstMs){
+    groups.clear();
+    remaining = 0;
+    for(const auto& group : g){
+        if(group.count <= 0)
+            continue;
+        groups.push_back(group);
+        remaining += group.count;
+    }
+    dueMs = firstMs;
+}
 
-    std::uniform_int_distribution<int> unif(0,2);
+void SpawnStream::clear(){
+    groups.clear();
+    remaining = 0;
+}
 
-    do{
-        int token = unif(generator);
-        switch( token ){
-            case 0:
-                if(spawnTokens >= 1){
-                    spawnList.push_back(new Enemy(Enemy_Type::NORMAL, spawnLocation));
-                    spawnTokens -= 1;
-                }
-                break;
-            case 1:
-                if(spawnTokens >= 3){
-                    spawnList.push_back(new Enemy(Enemy_Type::BADASS, spawnLocation));
-                    spawnTokens -= 3;
-                }
-                break;
-            case 2:
-                if(spawnTokens >= 3){
-                    spawnList.push_back(new Enemy(Enemy_Type::BAT, spawnLocation));
-                    spawnTokens -= 3;
-                }
+//The next spawn is timed from when this one was due rather than from the tick it happened on,
+//so spacings shorter than a tick still come out at the right rate
+int SpawnStream::take(int pick){
+    size_t i = 0;
+    while(pick >= groups[i].count){
+        pick -= groups[i].count;
+        i++;
+    }
+
+    int type = groups[i].type;
+    dueMs += groups[i].spacing;
+    remaining--;
+    if(--groups[i].count == 0)
+        groups.erase(groups.begin()+i);
+    return type;
+}
+
+std::vector<SpawnGroup> WaveGenerator::generateSpawnList(int wave){
+    const int budget = getTokens(wave);
+    int spawnTokens = budget;
+
+    const int types = EnemyTable::size();
+    std::vector<double> weights(types);
+    std::vector<int> counts(types);
+    double totalWeight = 0;
+    int cheapest = 0;
+    for(int i = 0; i < types; i++){
+        weights[i] = curve(i).getWeight(wave);
+        counts[i] = 0;
+        totalWeight += weights[i];
+        if(curve(i).tokenCost < curve(cheapest).tokenCost)
+            cheapest = i;
+    }
+    if(totalWeight <= 0){
+        weights[cheapest] = 1;
+        totalWeight = 1;
+    }
+
+    //Split the budget by weight, then hand out what is left one enemy at a time to the types that can still afford it
+    for(int i = 0; i < types; i++){
+        counts[i] = static_cast<int>(budget * (weights[i]/totalWeight)) / curve(i).tokenCost;
+        spawnTokens -= counts[i] * curve(i).tokenCost;
+    }
+
+    while(spawnTokens > 0){
+        double affordable = 0;
+        for(int i = 0; i < types; i++)
+            if(weights[i] > 0 && curve(i).tokenCost <= spawnTokens)
+                affordable += weights[i];
+        if(affordable <= 0)
+            break;
+
+        double r = std::uniform_real_distribution<double>(0, affordable)(generator);
+        int pick = cheapest;
+        for(int i = 0; i < types; i++){
+            if(weights[i] <= 0 || curve(i).tokenCost > spawnTokens)
+                continue;
+            pick = i;
+            if((r -= weights[i]) < 0)
                 break;
         }
-    }while(spawnTokens > 0);
+        counts[pick]++;
+        spawnTokens -= curve(pick).tokenCost;
+    }
+
+    std::vector<SpawnGroup> spawnList;
+    for(int i = 0; i < types; i++)
+        if(counts[i] > 0)
+            spawnList.push_back(SpawnGroup(i, counts[i], curve(i).getSpacing(wave)));
     return spawnList;
 }
+
+//Picks the next enemy to spawn with probability proportional to what is left of each group, so the wave stays mixed
+int WaveGenerator::takeNext(SpawnStream& stream){
+    return stream.take(std::uniform_int_distribution<int>(0, stream.getRemaining() - 1)(generator));
+}
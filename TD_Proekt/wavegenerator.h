@@ -2,25 +2,89 @@
 #define WAVEGENERATOR_H
 
 #include<vector>
-#include "enemy.h"
+#include "enemytable.h"
+#include <QtGlobal>
 #include<chrono>
 #include<random>
 
 #define DEFAULT std::default_random_engine
 #define SEED (unsigned int)std::chrono::system_clock::now().time_since_epoch().count()
 
+namespace WAVE {
+    const int TOKENS_PER_STEP = 10;
+    const double STEP_PER_WAVE = 0.2;
+}
 
+//Compact description of a wave: how many enemies of an archetype, and the delay before each of them spawns
+class SpawnGroup
+{
+public:
+    SpawnGroup(int t, int c, int s) : type(t), count(c), spacing(s) {}
+
+    int type;
+    int count;
+    int spacing;
+};
+
+
+//A pending wave read lazily: what is left of each archetype and when the next enemy is due. Taking an
+//enemy only decrements a count, so a wave costs the same few words of memory however long it is.
+class SpawnStream
+{
+public:
+    SpawnStream() : remaining(0), dueMs(0) {}
+
+    void start(const std::vector<SpawnGroup>& groups, qint64 firstMs);
+    void clear();
+    int take(int pick);  //archetype of the pick-th enemy still to come, schedules the one after it
+
+    inline bool isDue(qint64 ms) const { return remaining > 0 && ms >= dueMs; }
+    inline int getRemaining() const { return remaining; }
+    inline qint64 getDueMs() const { return dueMs; }
+    inline const std::vector<SpawnGroup>& getGroups() const { return groups; }
+private:
+    std::vector<SpawnGroup> groups;  //at most one per archetype
+    int remaining;
+    qint64 dueMs;  //simulation time the next enemy spawns at
+};
+
+
+//The wave engine plus the seed it started from and how many numbers it has handed out. Those two pin
+//down its state, so a state hash can take them instead of the standard engines' text serialisation.
+class CountedEngine
+{
+public:
+    typedef DEFAULT::result_type result_type;
+
+    CountedEngine(unsigned int s) : engine(s), seedValue(s), draws(0) {}
+
+    static constexpr result_type min() { return DEFAULT::min(); }
+    static constexpr result_type max() { return DEFAULT::max(); }
+    inline result_type operator()() { draws++; return engine(); }
+
+    inline void seed(unsigned int s) { engine.seed(s); seedValue = s; draws = 0; }
+    inline unsigned int getSeed() const { return seedValue; }
+    inline quint64 getDraws() const { return draws; }
+private:
+    DEFAULT engine;
+    unsigned int seedValue;
+    quint64 draws;
+};
+
+//Splits a wave's token budget across the archetypes in EnemyTable using their WaveCurves
 class WaveGenerator
 {
 public:
     WaveGenerator() : generator(SEED) {}
 
-    std::vector<Enemy*> generateSpawnList(int wave, QPointF spawnLocation);
-private:
-    DEFAULT generator;
-    std::vector<Enemy*> spawnList;
+    std::vector<SpawnGroup> generateSpawnList(int wave);
+    int takeNext(SpawnStream& stream);
+    inline void seed(unsigned int s) { generator.seed(s); }
+    inline const CountedEngine& getEngine() const { return generator; }
 
-    void clearSpawnList();
+    static int getTokens(int wave);
+private:
+    CountedEngine generator;
 };
 
 #endif // WAVEGENERATOR_H